@@ -135,6 +135,7 @@ set(include_files_list
     langinfo.h
     libio.h
     linux/falloc.h
+    liburing.h
     limits.h
     locale.h
     math.h
@@ -159,6 +160,7 @@ set(include_files_list
     string.h
     strings.h
     sys/dir.h
+    sys/epoll.h
     sys/file.h
     sys/ioctl.h
     sys/ipc.h
@@ -219,6 +221,7 @@ set(functions_list
     poll
     posix_fadvise
     pread pwrite
+    preadv
     pthread_cancel
     pthread_keycreate pthread_key_create
     pthread_mutexattr_setprotocol
@@ -256,7 +259,10 @@ check_library_exists(dl dladdr "${CMAKE_LIBRARY_PREFIX}" HAVE_DLADDR)
 check_library_exists(m fegetenv "${CMAKE_LIBRARY_PREFIX}" HAVE_FEGETENV)
 check_library_exists(m llrint "${CMAKE_LIBRARY_PREFIX}" HAVE_LLRINT)
 check_library_exists(pthread sem_init "${CMAKE_LIBRARY_PREFIX}" HAVE_SEM_INIT)
-check_library_exists(pthread sem_timedwait "${CMAKE_LIBRARY_PREFIX}" HAVE_SEM_TIMEDWAIT)  
+check_library_exists(pthread sem_timedwait "${CMAKE_LIBRARY_PREFIX}" HAVE_SEM_TIMEDWAIT)
+if (HAVE_LIBURING_H)
+    check_library_exists(uring io_uring_queue_init "${CMAKE_LIBRARY_PREFIX}" HAVE_LIBURING)
+endif()
 
 check_type_size(caddr_t HAVE_CADDR_T)
 check_c_source_compiles("#include <sys/sem.h>\nmain(){union semun s;return 0;}" HAVE_SEMUN)
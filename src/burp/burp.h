@@ -929,6 +929,7 @@ const FB_UINT64 MIN_SPLIT_SIZE	= FB_CONST64(2048);		// bytes
 // Global switches and data
 
 struct BurpCrypt;
+class MvolWriter;
 
 
 class GblPool
@@ -1067,6 +1068,7 @@ public:
 	UCHAR*		gbl_crypt_buffer;
 	ULONG		gbl_crypt_left;
 	UCHAR*      gbl_decompress;
+	MvolWriter*	gbl_writer = nullptr;
 	bool		gbl_default_pub_active = false;
 	bool		gbl_default_pub_auto_enable = false;
 
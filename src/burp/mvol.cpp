@@ -67,6 +67,9 @@
 #include "../common/db_alias.h"
 #include "../common/status.h"
 #include "../common/classes/zip.h"
+#include "../common/classes/condition.h"
+#include "../common/ThreadStart.h"
+#include "../common/msg_encode.h"
 
 using MsgFormat::SafeArg;
 using Firebird::FbLocalStatus;
@@ -93,6 +96,8 @@ static void	 brio_fini(BurpGlobals*);
 
 static const int MAX_HEADER_SIZE		= 512;
 static const int ZC_BUFSIZE				= IO_BUFFER_SIZE;
+// Number of compress buffers circulating between the master and the writer thread
+static const int MVOL_WRITER_BUFFERS	= 16;
 
 static inline int get(BurpGlobals* tdgbl)
 {
@@ -126,9 +131,9 @@ static bool  read_header(DESC, ULONG*, USHORT*, bool);
 static bool  write_header(DESC, ULONG, bool);
 static DESC	 next_volume(DESC, ULONG, bool);
 static void	 os_read(int*, UCHAR**);
-static void	 crypt_write_block(BurpGlobals*, const UCHAR*, FB_SIZE_T, bool);
+static void	 crypt_write_block(BurpGlobals*, const UCHAR*, FB_SIZE_T, bool, Firebird::UCharBuffer* = NULL);
 static ULONG crypt_read_block(BurpGlobals*, UCHAR*, FB_SIZE_T);
-static void	 zip_write_block(BurpGlobals*, const UCHAR*, FB_SIZE_T, bool);
+static void	 zip_write_block(BurpGlobals*, const UCHAR*, FB_SIZE_T, bool, Firebird::UCharBuffer* = NULL);
 static ULONG unzip_read_block(BurpGlobals*, UCHAR*, FB_SIZE_T);
 
 // Portion of data passed to crypt plugin
@@ -310,11 +315,16 @@ static void start_crypt(BurpGlobals* tdgbl)
 //____________________________________________________________
 //
 //
-static void crypt_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T buffer_length, bool flash)
+// Data is written to the backup file, or appended to the output buffer if one is given
+static void crypt_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T buffer_length, bool flash,
+	Firebird::UCharBuffer* output)
 {
 	if (!(tdgbl->gbl_sw_keyholder))
 	{
-		mvol_write_block(tdgbl, buffer, buffer_length);
+		if (output)
+			output->add(buffer, buffer_length);
+		else
+			mvol_write_block(tdgbl, buffer, buffer_length);
 		return;
 	}
 
@@ -349,7 +359,10 @@ static void crypt_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T
 			check(&status);
 		}
 
-		mvol_write_block(tdgbl, tdgbl->gbl_crypt_buffer, step);
+		if (output)
+			output->add(tdgbl->gbl_crypt_buffer, step);
+		else
+			mvol_write_block(tdgbl, tdgbl->gbl_crypt_buffer, step);
 		memmove(tdgbl->gbl_crypt_buffer, &tdgbl->gbl_crypt_buffer[step], tdgbl->gbl_crypt_left);
 	}
 }
@@ -489,11 +502,13 @@ static ULONG unzip_read_block(BurpGlobals* tdgbl, UCHAR* buffer, FB_SIZE_T buffe
 #endif
 }
 
-static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T buffer_length, bool flash)
+// Data is written to the backup file, or appended to the output buffer if one is given
+static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T buffer_length, bool flash,
+	Firebird::UCharBuffer* output)
 {
 	if (!tdgbl->gbl_sw_zip)
 	{
-		crypt_write_block(tdgbl, buffer, buffer_length, flash);
+		crypt_write_block(tdgbl, buffer, buffer_length, flash, output);
 		return;
 	}
 
@@ -528,6 +543,10 @@ static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T b
 #ifdef COMPRESS_DEBUG
 			fprintf(stderr, "Deflate error %d\n", ret);
 #endif
+			// Writer thread doesn't report errors itself, see MvolWriter::run()
+			if (output)
+				(Firebird::Arg::Gds(ENCODE_ISC_MSG(380, burp_msg_fac)) << Firebird::Arg::Num(ret)).raise();
+
 			BURP_error(380, true, SafeArg() << ret);
 		}
 
@@ -543,7 +562,7 @@ static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T b
 		expectMoreOut = !strm.avail_out;
 		if ((ZC_BUFSIZE != strm.avail_out) && (flash || !strm.avail_out))
 		{
-			crypt_write_block(tdgbl, compressed, ZC_BUFSIZE - strm.avail_out, flash);
+			crypt_write_block(tdgbl, compressed, ZC_BUFSIZE - strm.avail_out, flash, output);
 
 			strm.avail_out = ZC_BUFSIZE;
 			strm.next_out = (Bytef*)compressed;
@@ -556,6 +575,272 @@ static void zip_write_block(BurpGlobals* tdgbl, const UCHAR* buffer, FB_SIZE_T b
 
 
 
+//____________________________________________________________
+//
+// Compresses and encrypts filled compress buffers in a separate thread, letting
+// the master collect the next portion of data meanwhile. The processed data is
+// written by the master, in the original order, so the backup file is the same
+// as when written inline, and volume switching and all user I/O stay in the
+// master thread. Failures of the writer are passed back and raised by the master.
+//
+class MvolWriter
+{
+public:
+	explicit MvolWriter(BurpGlobals* tdgbl);
+	~MvolWriter();
+
+	UCHAR* write(UCHAR* buffer, FB_SIZE_T length);
+	void flush();
+
+private:
+	struct Block
+	{
+		explicit Block(MemoryPool& pool)
+			: buffer(NULL), length(0), output(pool)
+		{}
+
+		UCHAR* buffer;					// data collected by master
+		FB_SIZE_T length;
+		Firebird::UCharBuffer output;	// compressed and encrypted data
+	};
+
+	static THREAD_ENTRY_DECLARE writerThread(THREAD_ENTRY_PARAM arg);
+	void run();
+	void writeDone(Firebird::MutexLockGuard& guard);
+	void raiseError();
+
+	BurpGlobals* const m_tdgbl;
+	Firebird::Mutex m_mutex;
+	Firebird::Condition m_dirtyCond;		// signalled by master when a block is queued
+	Firebird::Condition m_doneCond;			// signalled by writer when a block is processed
+	Firebird::HalfStaticArray<Block*, MVOL_WRITER_BUFFERS> m_blocks;	// all blocks, for cleanup
+	Firebird::HalfStaticArray<Block*, MVOL_WRITER_BUFFERS> m_dirty;		// queued for processing
+	Firebird::HalfStaticArray<Block*, MVOL_WRITER_BUFFERS> m_done;		// processed, not written yet
+	Firebird::HalfStaticArray<Block*, MVOL_WRITER_BUFFERS> m_clean;		// free for master
+	Block* m_current;						// block filled by master
+	Thread::Handle m_handle;
+	FbLocalStatus m_status;
+	bool m_stop;
+	bool m_failed;
+};
+
+MvolWriter::MvolWriter(BurpGlobals* tdgbl)
+	: m_tdgbl(tdgbl),
+	  m_blocks(tdgbl->getPool()),
+	  m_dirty(tdgbl->getPool()),
+	  m_done(tdgbl->getPool()),
+	  m_clean(tdgbl->getPool()),
+	  m_current(NULL),
+	  m_handle(0),
+	  m_stop(false),
+	  m_failed(false)
+{
+	MemoryPool& pool = tdgbl->getPool();
+
+	for (int n = 0; n < MVOL_WRITER_BUFFERS; n++)
+	{
+		Block* const block = FB_NEW_POOL(pool) Block(pool);
+		m_blocks.push(block);
+
+		// The current compress buffer is the buffer of the first block
+		if (n)
+		{
+			block->buffer = FB_NEW_POOL(pool) UCHAR[ZC_BUFSIZE];
+			m_clean.push(block);
+		}
+		else
+		{
+			block->buffer = tdgbl->gbl_compress_buffer;
+			m_current = block;
+		}
+	}
+
+	Thread::start(writerThread, this, THREAD_medium, &m_handle);
+}
+
+MvolWriter::~MvolWriter()
+{
+	{	// scope
+		Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		m_stop = true;
+		m_dirtyCond.notifyAll();
+	}
+
+	Thread::waitForCompletion(m_handle);
+
+	// Buffer owned by master is released by brio_fini()
+	for (Block** block = m_blocks.begin(); block < m_blocks.end(); block++)
+	{
+		if ((*block)->buffer != m_tdgbl->gbl_compress_buffer)
+			delete[] (*block)->buffer;
+
+		delete *block;
+	}
+}
+
+// Queue filled buffer for output and return a clean one
+UCHAR* MvolWriter::write(UCHAR* buffer, FB_SIZE_T length)
+{
+	Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	fb_assert(buffer == m_current->buffer);
+
+	if (!m_failed)
+	{
+		m_current->length = length;
+		m_dirty.push(m_current);
+		m_current = NULL;
+		m_dirtyCond.notifyOne();
+
+		// Write what is already processed, wait for a block if no one is clean
+
+		writeDone(guard);
+
+		while (m_clean.isEmpty() && !m_failed)
+		{
+			m_doneCond.wait(m_mutex);
+			writeDone(guard);
+		}
+	}
+
+	if (m_failed)
+	{
+		guard.release();
+		raiseError();
+	}
+
+	m_current = m_clean.pop();
+	return m_current->buffer;
+}
+
+// Wait until all queued buffers are written
+void MvolWriter::flush()
+{
+	Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while ((m_dirty.hasData() || m_done.hasData()) && !m_failed)
+	{
+		if (m_done.isEmpty())
+			m_doneCond.wait(m_mutex);
+
+		writeDone(guard);
+	}
+
+	if (m_failed)
+	{
+		guard.release();
+		raiseError();
+	}
+}
+
+// Write processed blocks to the backup file in the master thread
+void MvolWriter::writeDone(Firebird::MutexLockGuard& guard)
+{
+	while (m_done.hasData() && !m_failed)
+	{
+		Block* const block = m_done[0];
+
+		{	// scope
+			Firebird::MutexUnlockGuard unlock(m_mutex, FB_FUNCTION);
+			mvol_write_block(m_tdgbl, block->output.begin(), block->output.getCount());
+		}
+
+		block->output.clear();
+		m_done.remove((FB_SIZE_T) 0);
+		m_clean.push(block);
+	}
+}
+
+// Report writer failure in the master's context
+void MvolWriter::raiseError()
+{
+	BURP_abort(&m_status);
+}
+
+THREAD_ENTRY_DECLARE MvolWriter::writerThread(THREAD_ENTRY_PARAM arg)
+{
+	MvolWriter* writer = static_cast<MvolWriter*>(arg);
+	writer->run();
+	return 0;
+}
+
+// Compress and encrypt queued blocks. Errors are not reported here,
+// the status is saved for the master to raise it.
+void MvolWriter::run()
+{
+	Firebird::MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (true)
+	{
+		while (m_dirty.isEmpty() && !m_stop)
+			m_dirtyCond.wait(m_mutex);
+
+		if (m_stop)
+			break;
+
+		Block* const block = m_dirty[0];
+
+		try
+		{
+			Firebird::MutexUnlockGuard unlock(m_mutex, FB_FUNCTION);
+			zip_write_block(m_tdgbl, block->buffer, block->length, false, &block->output);
+		}
+		catch (const Firebird::Exception& ex)
+		{
+			ex.stuffException(&m_status);
+			m_failed = true;
+			m_doneCond.notifyAll();
+			break;
+		}
+
+		m_dirty.remove((FB_SIZE_T) 0);
+		m_done.push(block);
+		m_doneCond.notifyOne();
+	}
+}
+
+
+//____________________________________________________________
+//
+// Pass the filled compress buffer to the output and make it ready for new data.
+// Compression and encryption are CPU bound: when parallel workers are allowed,
+// run them in a separate writer thread.
+//
+static void write_compress_buffer(BurpGlobals* tdgbl)
+{
+	const FB_SIZE_T length = tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer;
+
+	if (!tdgbl->gbl_writer && tdgbl->gbl_sw_par_workers > 1 &&
+		(tdgbl->gbl_sw_zip || tdgbl->gbl_sw_keyholder))
+	{
+		if (tdgbl->gbl_sw_keyholder)
+			start_crypt(tdgbl);
+
+		tdgbl->gbl_writer = FB_NEW_POOL(tdgbl->getPool()) MvolWriter(tdgbl);
+	}
+
+	if (tdgbl->gbl_writer)
+		tdgbl->gbl_compress_buffer = tdgbl->gbl_writer->write(tdgbl->gbl_compress_buffer, length);
+	else
+		zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, length, false);
+
+	tdgbl->gbl_io_ptr = tdgbl->gbl_compress_buffer;
+	tdgbl->gbl_io_cnt = ZC_BUFSIZE;
+}
+
+
+//____________________________________________________________
+//
+// Stop the writer thread, if any. Queued but not written buffers are discarded.
+//
+void MVOL_stop_writer(BurpGlobals* tdgbl)
+{
+	delete tdgbl->gbl_writer;
+	tdgbl->gbl_writer = NULL;
+}
+
+
+
 //____________________________________________________________
 //
 //
@@ -606,6 +891,12 @@ FB_UINT64 MVOL_fini_write()
 {
 	BurpGlobals* tdgbl = BurpGlobals::getSpecific();
 
+	if (tdgbl->gbl_writer)
+	{
+		tdgbl->gbl_writer->flush();
+		MVOL_stop_writer(tdgbl);
+	}
+
 	zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer, true);
 
 #ifdef HAVE_ZLIB_H
@@ -1111,10 +1402,7 @@ void MVOL_write(BurpGlobals* tdgbl)
 	fb_assert(tdgbl->gbl_io_ptr >= tdgbl->gbl_compress_buffer);
 	fb_assert(tdgbl->gbl_io_ptr <= tdgbl->gbl_compress_buffer + ZC_BUFSIZE);
 
-	zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer, false);
-
-	tdgbl->gbl_io_cnt = ZC_BUFSIZE;
-	tdgbl->gbl_io_ptr = tdgbl->gbl_compress_buffer;
+	write_compress_buffer(tdgbl);
 }
 
 UCHAR mvol_write(const UCHAR c, int* io_cnt, UCHAR** io_ptr)
@@ -1356,12 +1644,7 @@ const UCHAR* MVOL_write_block(BurpGlobals* tdgbl, const UCHAR* ptr, ULONG count)
 				BackupRelationTask::renewBuffer(tdgbl);
 			}
 			else
-			{
-				zip_write_block(tdgbl, tdgbl->gbl_compress_buffer, tdgbl->gbl_io_ptr - tdgbl->gbl_compress_buffer, false);
-
-				tdgbl->gbl_io_ptr = tdgbl->gbl_compress_buffer;
-				tdgbl->gbl_io_cnt = ZC_BUFSIZE;
-			}
+				write_compress_buffer(tdgbl);
 		}
 
 		const ULONG n = MIN(count, (ULONG) tdgbl->gbl_io_cnt);
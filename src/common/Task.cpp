@@ -255,6 +255,53 @@ void Coordinator::runSync(Task* task)
 	}
 }
 
+void Coordinator::runAsync(Task* task)
+{
+	fb_assert(m_asyncWorkers.isEmpty());
+
+	const int cntWorkers = setupWorkers(task->getMaxWorkers());
+	if (cntWorkers < 1)
+		return;
+
+	for (int i = 0; i < cntWorkers; i++)
+	{
+		WorkerThread* thd = getThread();
+		if (!thd)
+			break;
+
+		Worker* w = getWorker();
+		m_asyncWorkers.push(WorkerAndThd(w, thd));
+
+		w->setTask(task);
+		thd->runWorker(w);
+	}
+
+	// no threads available - run syncronously
+	if (m_asyncWorkers.isEmpty())
+	{
+		Worker* syncWorker = getWorker();
+		syncWorker->setTask(task);
+		syncWorker->work(NULL);
+		releaseWorker(syncWorker);
+	}
+}
+
+void Coordinator::waitAsync()
+{
+	for (FB_SIZE_T i = 0; i < m_asyncWorkers.getCount(); i++)
+	{
+		WorkerAndThd& wt = m_asyncWorkers[i];
+
+		if (!wt.worker->isIdle())
+			wt.thread->waitForState(WorkerThread::IDLE, -1);
+
+		releaseThread(wt.thread);
+		releaseWorker(wt.worker);
+	}
+
+	m_asyncWorkers.clear();
+}
+
 Worker* Coordinator::getWorker()
 {
 	MutexLockGuard guard(m_mutex, FB_FUNCTION);
@@ -112,6 +112,7 @@ class Coordinator final
 public:
 	Coordinator(MemoryPool* pool) :
 		m_pool(pool),
+		m_asyncWorkers(*m_pool),
 		m_workers(*m_pool),
 		m_idleWorkers(*m_pool),
 		m_activeWorkers(*m_pool),
@@ -123,6 +124,11 @@ public:
 
 	void runSync(Task*);
 
+	// start the task using worker threads and return immediately,
+	// waitAsync() must be called before next task could be started
+	void runAsync(Task*);
+	void waitAsync();
+
 private:
 	struct WorkerAndThd
 	{
@@ -151,6 +157,7 @@ private:
 
 	MemoryPool* m_pool;
 	Mutex m_mutex;
+	HalfStaticArray<WorkerAndThd, 8> m_asyncWorkers;
 	HalfStaticArray<Worker*, 8> m_workers;
 	HalfStaticArray<Worker*, 8> m_idleWorkers;
 	HalfStaticArray<Worker*, 8> m_activeWorkers;
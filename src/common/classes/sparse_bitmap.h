@@ -32,6 +32,10 @@
 
 #include "../common/classes/alloc.h"
 
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+#endif
+
 namespace Firebird {
 
 struct BitmapTypes_32
@@ -214,6 +218,46 @@ protected:
 		BUNCH_BITS = InternalTypes::BUNCH_BITS
 	};
 
+	// Number of buckets skipped one by one during bitmap merge,
+	// longer gaps are skipped by a tree lookup
+	static const unsigned MAX_SEQUENTIAL_SKIPS = 8;
+
+	// Index of the lowest set bit of a non-zero bunch
+	static unsigned lowestBit(BUNCH_T bits)
+	{
+		fb_assert(bits);
+#if defined(__GNUC__)
+		return __builtin_ctzll(bits);
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long index;
+		_BitScanForward64(&index, bits);
+		return index;
+#else
+		unsigned index = 0;
+		for (; !(bits & BUNCH_ONE); bits >>= 1)
+			index++;
+		return index;
+#endif
+	}
+
+	// Index of the highest set bit of a non-zero bunch
+	static unsigned highestBit(BUNCH_T bits)
+	{
+		fb_assert(bits);
+#if defined(__GNUC__)
+		return 63 - __builtin_clzll(bits);
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long index;
+		_BitScanReverse64(&index, bits);
+		return index;
+#else
+		unsigned index = 0;
+		while (bits >>= 1)
+			index++;
+		return index;
+#endif
+	}
+
 	// Bucket with bits
 	struct Bucket
 	{
@@ -320,83 +364,45 @@ public:
 					return treeAccessor.current().bits & bit_mask;
 				case locGreatEqual:
 				{
-					// Initialize bit_mask
-					if (treeAccessor.current().start_value == key_aligned) {
-						current_value = key;
-						bit_mask = BUNCH_ONE << (key - key_aligned);
-					}
-					else {
-						current_value = treeAccessor.current().start_value;
-						bit_mask = BUNCH_ONE;
-					}
+					const BUNCH_T start_mask = (treeAccessor.current().start_value == key_aligned) ?
+						BUNCH_ONE << (key - key_aligned) : BUNCH_ONE;
 
 					// Scan bucket forwards looking for a match
-					BUNCH_T tree_bits = treeAccessor.current().bits;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask <<= 1;
-						current_value++;
-					} while (bit_mask);
+					if (scanForward(start_mask))
+						return true;
 
 					// We scanned bucket, but found no match.
 					// No problem, scan the next bucket (there should be at least one bit set for a bucket)
 					if (!treeAccessor.getNext())
 						return false;
 
-					tree_bits = treeAccessor.current().bits;
-					bit_mask = BUNCH_ONE;
-					current_value = treeAccessor.current().start_value;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask <<= 1;
-						current_value++;
-					} while (bit_mask);
+					if (scanForward(BUNCH_ONE))
+						return true;
 
 					// Bucket must contain one bit at least
 					fb_assert(false);
+					return false;
 				}
 				case locLessEqual:
 				{
-					// Initialize bit_mask
-					if (treeAccessor.current().start_value == key_aligned)
-					{
-						current_value = key;
-						bit_mask = BUNCH_ONE << (key - key_aligned);
-					}
-					else
-					{
-						current_value = treeAccessor.current().start_value;
-						bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-					}
+					const BUNCH_T start_mask = (treeAccessor.current().start_value == key_aligned) ?
+						BUNCH_ONE << (key - key_aligned) : BUNCH_ONE << (BUNCH_BITS - 1);
 
 					// Scan bucket backwards looking for a match
-					BUNCH_T tree_bits = treeAccessor.current().bits;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask >>= 1;
-						current_value--;
-					} while (bit_mask);
+					if (scanBackward(start_mask))
+						return true;
 
 					// We scanned bucket, but found no match.
 					// No problem, scan the next bucket (there should be at least one bit set for a bucket)
 					if (!treeAccessor.getPrev())
 						return false;
 
-					tree_bits = treeAccessor.current().bits;
-					bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-					current_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-					do {
-						if (tree_bits & bit_mask)
-							return true;
-						bit_mask >>= 1;
-						current_value--;
-					} while (bit_mask);
+					if (scanBackward(BUNCH_ONE << (BUNCH_BITS - 1)))
+						return true;
 
 					// Bucket must contain one bit at least
 					fb_assert(false);
+					return false;
 				}
 
 				default:
@@ -423,15 +429,8 @@ public:
 			if (!treeAccessor.getFirst())
 				return false;
 
-			const BUNCH_T tree_bits = treeAccessor.current().bits;
-			bit_mask = BUNCH_ONE;
-			current_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & bit_mask)
-					return true;
-				bit_mask <<= 1;
-				current_value++;
-			} while (bit_mask);
+			if (scanForward(BUNCH_ONE))
+				return true;
 
 			// Bucket must contain one bit at least
 			fb_assert(false);
@@ -455,18 +454,12 @@ public:
 			if (!treeAccessor.getLast())
 				return false;
 
-			const BUNCH_T tree_bits = treeAccessor.current().bits;
-			bit_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-			current_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-			do {
-				if (tree_bits & bit_mask)
-					return true;
-				bit_mask >>= 1;
-				current_value--;
-			} while (bit_mask);
+			if (scanBackward(BUNCH_ONE << (BUNCH_BITS - 1)))
+				return true;
 
 			// Bucket must contain one bit at least
 			fb_assert(false);
+			return false;
 		}
 
 		// Accessor position must be establised via successful call to getFirst(),
@@ -476,45 +469,19 @@ public:
 			if (bitmap->singular)
 				return false;
 
-			// Use temporaries to avoid corrupting position if there is no next item in bitmap
-			BUNCH_T try_mask = bit_mask;
-			T try_value = current_value;
-
-			// Proceed to next value
-			try_mask <<= 1;
-			try_value++;
-
-			// Scan bucket forwards looking for a match
-			BUNCH_T tree_bits = treeAccessor.current().bits;
-			while (try_mask)
-			{
-				if (tree_bits & try_mask)
-				{
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask <<= 1;
-				try_value++;
-			}
+			// Scan bucket forwards looking for a match.
+			// Position is changed only if there is a next item in bitmap.
+			const BUNCH_T try_mask = bit_mask << 1;
+			if (try_mask && scanForward(try_mask))
+				return true;
 
 			// We scanned bucket, but found no match.
 			// No problem, scan the next bucket (there should be at least one bit set for a bucket)
 			if (!treeAccessor.getNext())
 				return false;
 
-			tree_bits = treeAccessor.current().bits;
-			try_mask = BUNCH_ONE;
-			try_value = treeAccessor.current().start_value;
-			do {
-				if (tree_bits & try_mask) {
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask <<= 1;
-				try_value++;
-			} while (try_mask);
+			if (scanForward(BUNCH_ONE))
+				return true;
 
 			// Bucket must contain one bit at least
 			fb_assert(false);
@@ -528,53 +495,55 @@ public:
 			if (bitmap->singular)
 				return false;
 
-			// Use temporaries to avoid corrupting position if there is no next item in bitmap
-			BUNCH_T try_mask = bit_mask;
-			T try_value = current_value;
-
-			// Proceed to next value
-			try_mask >>= 1;
-			try_value--;
-
-			// Scan bucket backwards looking for a match
-			BUNCH_T tree_bits = treeAccessor.current().bits;
-			while (try_mask)
-			{
-				if (tree_bits & try_mask)
-				{
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask >>= 1;
-				try_value--;
-			}
+			// Scan bucket backwards looking for a match.
+			// Position is changed only if there is a previous item in bitmap.
+			const BUNCH_T try_mask = bit_mask >> 1;
+			if (try_mask && scanBackward(try_mask))
+				return true;
 
 			// We scanned bucket, but found no match.
 			// No problem, scan the next bucket (there should be at least one bit set for a bucket)
 			if (!treeAccessor.getPrev())
 				return false;
 
-			tree_bits = treeAccessor.current().bits;
-			try_mask = BUNCH_ONE << (BUNCH_BITS - 1);
-			try_value = treeAccessor.current().start_value + BUNCH_BITS - 1;
-			do {
-				if (tree_bits & try_mask)
-				{
-					bit_mask = try_mask;
-					current_value = try_value;
-					return true;
-				}
-				try_mask >>= 1;
-				try_value--;
-			} while (bit_mask);
+			if (scanBackward(BUNCH_ONE << (BUNCH_BITS - 1)))
+				return true;
 
 			// Bucket must contain one bit at least
 			fb_assert(false);
+			return false;
 		}
 
 	    T current() const { return current_value; }
 	private:
+		// Position on the lowest bit of the current bucket, starting from the given mask.
+		// If there is no such bit, the position is not changed.
+		bool scanForward(BUNCH_T mask)
+		{
+			const BUNCH_T tree_bits = treeAccessor.current().bits & ~(mask - 1);
+			if (!tree_bits)
+				return false;
+
+			const unsigned bit = lowestBit(tree_bits);
+			bit_mask = BUNCH_ONE << bit;
+			current_value = treeAccessor.current().start_value + bit;
+			return true;
+		}
+
+		// Position on the highest bit of the current bucket, starting from the given mask.
+		// If there is no such bit, the position is not changed.
+		bool scanBackward(BUNCH_T mask)
+		{
+			const BUNCH_T tree_bits = treeAccessor.current().bits & (mask | (mask - 1));
+			if (!tree_bits)
+				return false;
+
+			const unsigned bit = highestBit(tree_bits);
+			bit_mask = BUNCH_ONE << bit;
+			current_value = treeAccessor.current().start_value + bit;
+			return true;
+		}
+
 		SparseBitmap* bitmap;
 		BitmapTreeAccessor treeAccessor;
 		BUNCH_T bit_mask;
@@ -651,6 +620,7 @@ SparseBitmap<T, InternalTypes>::bit_or(SparseBitmap<T, InternalTypes>** bitmap1,
 
 	T destValue = dest->tree.current().start_value;
 	T sourceValue = source->tree.current().start_value;
+	unsigned skips = 0;
 
 	while (sourceFound)
 	{
@@ -659,11 +629,21 @@ SparseBitmap<T, InternalTypes>::bit_or(SparseBitmap<T, InternalTypes>** bitmap1,
 			// See if we need to skip value in destination tree
 			if (destValue < sourceValue)
 			{
-				if ((destFound = dest->tree.getNext()))
+				if (++skips < MAX_SEQUENTIAL_SKIPS)
+					destFound = dest->tree.getNext();
+				else
+				{
+					destFound = dest->tree.locate(locGreatEqual, sourceValue);
+					skips = 0;
+				}
+
+				if (destFound)
 					destValue = dest->tree.current().start_value;
 				continue;
 			}
 
+			skips = 0;
+
 			// Positions of our trees match
 			if (destValue == sourceValue)
 			{
@@ -774,19 +754,30 @@ SparseBitmap<T, InternalTypes>::bit_and(SparseBitmap<T, InternalTypes>** bitmap1
 
 	T destValue = dest->tree.current().start_value;
 	T sourceValue = source->tree.current().start_value;
+	unsigned skips = 0;
 
 	while (destFound)
 	{
 		if (sourceFound)
 		{
-			// See if we need to skip value in destination tree
+			// See if we need to skip value in source tree
 			if (sourceValue < destValue)
 			{
-				if ((sourceFound = source->tree.getNext()))
+				if (++skips < MAX_SEQUENTIAL_SKIPS)
+					sourceFound = source->tree.getNext();
+				else
+				{
+					sourceFound = source->tree.locate(locGreatEqual, destValue);
+					skips = 0;
+				}
+
+				if (sourceFound)
 					sourceValue = source->tree.current().start_value;
 				continue;
 			}
 
+			skips = 0;
+
 			// Positions of our trees match
 			if (sourceValue == destValue)
 			{
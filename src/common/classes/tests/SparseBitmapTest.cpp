@@ -0,0 +1,291 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird development team
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 the Firebird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/alloc.h"
+#include "../common/classes/tree.h"
+#include "../common/classes/sparse_bitmap.h"
+#include <set>
+
+using namespace Firebird;
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(SparseBitmapSuite)
+
+
+namespace
+{
+	typedef SparseBitmap<ULONG> Bitmap;
+	typedef std::set<ULONG> Reference;
+
+	// Values around the edges of 64-bit buckets, including empty buckets in between
+	const ULONG boundaryValues[] = {0, 1, 62, 63, 64, 65, 127, 128, 191, 192, 255, 640, 703, 1000, 1023, 1024};
+
+	void fill(Bitmap& bitmap, Reference& reference, const ULONG* values, FB_SIZE_T count)
+	{
+		for (FB_SIZE_T i = 0; i < count; i++)
+		{
+			bitmap.set(values[i]);
+			reference.insert(values[i]);
+		}
+	}
+
+	void checkIteration(Bitmap& bitmap, const Reference& reference)
+	{
+		Bitmap::Accessor accessor(&bitmap);
+
+		auto forward = reference.begin();
+		for (bool found = accessor.getFirst(); found; found = accessor.getNext())
+		{
+			BOOST_TEST_REQUIRE((forward != reference.end()));
+			BOOST_TEST(accessor.current() == *forward);
+			++forward;
+		}
+		BOOST_TEST((forward == reference.end()));
+
+		auto backward = reference.rbegin();
+		for (bool found = accessor.getLast(); found; found = accessor.getPrev())
+		{
+			BOOST_TEST_REQUIRE((backward != reference.rend()));
+			BOOST_TEST(accessor.current() == *backward);
+			++backward;
+		}
+		BOOST_TEST((backward == reference.rend()));
+	}
+
+	void checkLocate(Bitmap& bitmap, const Reference& reference, ULONG maxKey)
+	{
+		Bitmap::Accessor accessor(&bitmap);
+
+		for (ULONG key = 0; key <= maxKey; key++)
+		{
+			BOOST_TEST_INFO("key " << key);
+
+			BOOST_TEST(accessor.locate(locEqual, key) == (reference.count(key) != 0));
+
+			const auto greatEqual = reference.lower_bound(key);
+			BOOST_TEST(accessor.locate(locGreatEqual, key) == (greatEqual != reference.end()));
+			if (greatEqual != reference.end())
+			{
+				BOOST_TEST(accessor.current() == *greatEqual);
+
+				// Continue iteration from the located position
+				auto next = greatEqual;
+				++next;
+				BOOST_TEST(accessor.getNext() == (next != reference.end()));
+				if (next != reference.end())
+					BOOST_TEST(accessor.current() == *next);
+			}
+
+			const auto great = reference.upper_bound(key);
+			BOOST_TEST(accessor.locate(locGreat, key) == (great != reference.end()));
+			if (great != reference.end())
+				BOOST_TEST(accessor.current() == *great);
+
+			auto lessEqual = reference.upper_bound(key);
+			const bool hasLessEqual = (lessEqual != reference.begin());
+			BOOST_TEST(accessor.locate(locLessEqual, key) == hasLessEqual);
+			if (hasLessEqual)
+			{
+				--lessEqual;
+				BOOST_TEST(accessor.current() == *lessEqual);
+
+				const bool hasPrior = (lessEqual != reference.begin());
+				BOOST_TEST(accessor.getPrev() == hasPrior);
+				if (hasPrior)
+					BOOST_TEST(accessor.current() == *--lessEqual);
+			}
+
+			auto less = reference.lower_bound(key);
+			const bool hasLess = (less != reference.begin());
+			BOOST_TEST(accessor.locate(locLess, key) == hasLess);
+			if (hasLess)
+				BOOST_TEST(accessor.current() == *--less);
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(SparseBitmapTests)
+
+BOOST_AUTO_TEST_CASE(EmptyBitmapTest)
+{
+	Bitmap bitmap;
+	Bitmap::Accessor accessor(&bitmap);
+
+	BOOST_TEST(!accessor.getFirst());
+	BOOST_TEST(!accessor.getLast());
+	BOOST_TEST(!accessor.locate(locEqual, 0));
+	BOOST_TEST(!accessor.locate(locGreatEqual, 0));
+	BOOST_TEST(!accessor.locate(locLessEqual, MAX_ULONG));
+
+	Bitmap::Accessor nullAccessor(nullptr);
+	BOOST_TEST(!nullAccessor.getFirst());
+	BOOST_TEST(!nullAccessor.locate(locGreatEqual, 0));
+}
+
+BOOST_AUTO_TEST_CASE(SingularBitmapTest)
+{
+	Bitmap bitmap;
+	Reference reference;
+
+	const ULONG value = 64;
+	fill(bitmap, reference, &value, 1);
+
+	checkIteration(bitmap, reference);
+	checkLocate(bitmap, reference, 200);
+}
+
+BOOST_AUTO_TEST_CASE(BucketBoundaryIterationTest)
+{
+	Bitmap bitmap;
+	Reference reference;
+
+	fill(bitmap, reference, boundaryValues, FB_NELEM(boundaryValues));
+
+	checkIteration(bitmap, reference);
+}
+
+BOOST_AUTO_TEST_CASE(BucketBoundaryLocateTest)
+{
+	Bitmap bitmap;
+	Reference reference;
+
+	fill(bitmap, reference, boundaryValues, FB_NELEM(boundaryValues));
+
+	checkLocate(bitmap, reference, 1100);
+}
+
+BOOST_AUTO_TEST_CASE(FullBucketTest)
+{
+	Bitmap bitmap;
+	Reference reference;
+
+	for (ULONG value = 128; value < 256; value++)
+		fill(bitmap, reference, &value, 1);
+
+	checkIteration(bitmap, reference);
+	checkLocate(bitmap, reference, 320);
+}
+
+BOOST_AUTO_TEST_CASE(ClearTest)
+{
+	Bitmap bitmap;
+	Reference reference;
+
+	fill(bitmap, reference, boundaryValues, FB_NELEM(boundaryValues));
+
+	// Empty the bucket [64, 127] and clear the lowest and highest values of others
+	const ULONG cleared[] = {0, 64, 65, 127, 1024};
+
+	for (const auto value : cleared)
+	{
+		BOOST_TEST(bitmap.clear(value));
+		reference.erase(value);
+	}
+
+	BOOST_TEST(!bitmap.clear(64));
+	BOOST_TEST(!bitmap.test(64));
+
+	checkIteration(bitmap, reference);
+	checkLocate(bitmap, reference, 1100);
+}
+
+BOOST_AUTO_TEST_CASE(BitOrAndTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const ULONG values1[] = {0, 63, 64, 200, 1023, 5000};
+	const ULONG values2[] = {63, 65, 200, 1024, 5000, 100000};
+
+	Reference reference1, reference2;
+	Bitmap* or1 = FB_NEW_POOL(pool) Bitmap(pool);
+	Bitmap* or2 = FB_NEW_POOL(pool) Bitmap(pool);
+	fill(*or1, reference1, values1, FB_NELEM(values1));
+	fill(*or2, reference2, values2, FB_NELEM(values2));
+
+	Reference referenceOr = reference1;
+	referenceOr.insert(reference2.begin(), reference2.end());
+
+	Bitmap** const resultOr = Bitmap::bit_or(&or1, &or2);
+	BOOST_TEST_REQUIRE(resultOr);
+	checkIteration(**resultOr, referenceOr);
+
+	Reference referenceAnd, dummy;
+	Bitmap* and1 = FB_NEW_POOL(pool) Bitmap(pool);
+	Bitmap* and2 = FB_NEW_POOL(pool) Bitmap(pool);
+	fill(*and1, dummy, values1, FB_NELEM(values1));
+	fill(*and2, dummy, values2, FB_NELEM(values2));
+
+	for (const auto value : reference1)
+	{
+		if (reference2.count(value))
+			referenceAnd.insert(value);
+	}
+
+	Bitmap** const resultAnd = Bitmap::bit_and(&and1, &and2);
+	BOOST_TEST_REQUIRE(resultAnd);
+	checkIteration(**resultAnd, referenceAnd);
+
+	delete or1;
+	delete or2;
+	delete and1;
+	delete and2;
+}
+
+BOOST_AUTO_TEST_CASE(SkippingBitAndTest)
+{
+	// The small bitmap makes the merge skip long runs of buckets in the large one
+
+	auto& pool = *getDefaultMemoryPool();
+
+	Reference referenceLarge, referenceSmall;
+	Bitmap* large = FB_NEW_POOL(pool) Bitmap(pool);
+	Bitmap* small = FB_NEW_POOL(pool) Bitmap(pool);
+
+	for (ULONG value = 0; value < 64 * 1000; value += 37)
+		fill(*large, referenceLarge, &value, 1);
+
+	const ULONG values[] = {37, 6401, 6438, 30000, 63973, 100000};
+	fill(*small, referenceSmall, values, FB_NELEM(values));
+
+	Reference referenceAnd;
+	for (const auto value : referenceSmall)
+	{
+		if (referenceLarge.count(value))
+			referenceAnd.insert(value);
+	}
+
+	Bitmap** const result = Bitmap::bit_and(&large, &small);
+	BOOST_TEST_REQUIRE(result);
+	checkIteration(**result, referenceAnd);
+
+	delete large;
+	delete small;
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SparseBitmapTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SparseBitmapSuite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
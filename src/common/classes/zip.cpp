@@ -28,10 +28,10 @@
 #include "../common/classes/alloc.h"
 #include "../common/classes/zip.h"
 
-#ifdef HAVE_ZLIB_H
-
 using namespace Firebird;
 
+#ifdef HAVE_ZLIB_H
+
 ZLib::ZLib(Firebird::MemoryPool&)
 {
 #ifdef WIN_NT
@@ -74,3 +74,29 @@ void ZLib::freeFunc(void*, void* address)
 }
 
 #endif // HAVE_ZLIB_H
+
+ZStd::ZStd(Firebird::MemoryPool&)
+{
+#ifdef WIN_NT
+	Firebird::PathName name("libzstd.dll");
+#else
+	Firebird::PathName name("libzstd." SHRLIB_EXT ".1");
+#endif
+	z.reset(ModuleLoader::fixAndLoadModule(status, name));
+	if (z)
+		symbols();
+}
+
+void ZStd::symbols()
+{
+#define FB_ZSYMB(A, B) z->findSymbol(status, STRINGIZE(B), A); if (!A) { z.reset(NULL); return; }
+	FB_ZSYMB(createCCtx, ZSTD_createCCtx)
+	FB_ZSYMB(freeCCtx, ZSTD_freeCCtx)
+	FB_ZSYMB(setParameter, ZSTD_CCtx_setParameter)
+	FB_ZSYMB(compressStream2, ZSTD_compressStream2)
+	FB_ZSYMB(createDCtx, ZSTD_createDCtx)
+	FB_ZSYMB(freeDCtx, ZSTD_freeDCtx)
+	FB_ZSYMB(decompressStream, ZSTD_decompressStream)
+	FB_ZSYMB(isError, ZSTD_isError)
+#undef FB_ZSYMB
+}
@@ -27,12 +27,12 @@
 #ifndef COMMON_ZIP_H
 #define COMMON_ZIP_H
 
-#ifdef HAVE_ZLIB_H
-#include <zlib.h>
-
 #include "../common/classes/auto.h"
 #include "../common/os/mod_loader.h"
 
+#ifdef HAVE_ZLIB_H
+#include <zlib.h>
+
 namespace Firebird {
 	class ZLib
 	{
@@ -62,4 +62,53 @@ namespace Firebird {
 }
 #endif // HAVE_ZLIB_H
 
+namespace Firebird {
+	// zstd library is loaded dynamically, its headers are not required to build.
+	// Types below match the stable part of zstd API (v1.4.0+), see zstd.h.
+	class ZStd
+	{
+	public:
+		struct InBuffer
+		{
+			const void* src;
+			size_t size;
+			size_t pos;
+		};
+
+		struct OutBuffer
+		{
+			void* dst;
+			size_t size;
+			size_t pos;
+		};
+
+		enum EndDirective { E_CONTINUE = 0, E_FLUSH = 1, E_END = 2 };
+		enum CParameter { C_COMPRESSION_LEVEL = 100 };
+
+		typedef void CCtx;
+		typedef void DCtx;
+
+		explicit ZStd(Firebird::MemoryPool&);
+
+		CCtx* (*createCCtx)();
+		size_t (*freeCCtx)(CCtx* cctx);
+		size_t (*setParameter)(CCtx* cctx, int param, int value);
+		size_t (*compressStream2)(CCtx* cctx, OutBuffer* output, InBuffer* input, int endOp);
+		DCtx* (*createDCtx)();
+		size_t (*freeDCtx)(DCtx* dctx);
+		size_t (*decompressStream)(DCtx* dctx, OutBuffer* output, InBuffer* input);
+		unsigned (*isError)(size_t code);
+
+		operator bool() { return z.hasData(); }
+		bool operator!() { return !z.hasData(); }
+
+		ISC_STATUS_ARRAY status;
+
+	private:
+		AutoPtr<ModuleLoader::Module> z;
+
+		void symbols();
+	};
+}
+
 #endif // COMMON_ZIP_H
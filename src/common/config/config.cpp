@@ -425,6 +425,14 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_MAX_STATEMENT_CACHE_SIZE, 0, true);
 
+	checkIntForLoBound(KEY_HASH_JOIN_MEMORY_LIMIT, 0, true);
+	checkIntForLoBound(KEY_HASH_AGGREGATE_MEMORY_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_READ_AHEAD_PAGES, 0, true);
+
+	checkIntForLoBound(KEY_WIRE_COMPRESSION_LEVEL, -22, false);
+	checkIntForHiBound(KEY_WIRE_COMPRESSION_LEVEL, 22, false);	// max zstd level
+
 	checkIntForLoBound(KEY_MAX_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_MAX_PARALLEL_WORKERS, 64, false);	// todo: detect number of available cores
 
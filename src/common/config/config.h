@@ -187,6 +187,11 @@ enum ConfigKey
 	KEY_PARALLEL_WORKERS,
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
+	KEY_HASH_JOIN_MEMORY_LIMIT,
+	KEY_HASH_AGGREGATE_MEMORY_LIMIT,
+	KEY_READ_AHEAD_PAGES,
+	KEY_WIRE_COMPRESSION_TYPE,
+	KEY_WIRE_COMPRESSION_LEVEL,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +305,12 @@ constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"MaxStatementCacheSize",	false,	2 * 1048576},	// bytes
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
-	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false}
+	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
+	{TYPE_INTEGER,	"HashJoinMemoryLimit",		false,	128 * 1048576},	// bytes
+	{TYPE_INTEGER,	"HashAggregateMemoryLimit",	false,	64 * 1048576},	// bytes
+	{TYPE_INTEGER,	"ReadAheadPages",			false,	64},	// pages
+	{TYPE_STRING,	"WireCompressionType",		false,	"zlib"},
+	{TYPE_INTEGER,	"WireCompressionLevel",		false,	0}
 };
 
 
@@ -624,6 +634,21 @@ public:
 	CONFIG_GET_GLOBAL_INT(getMaxParallelWorkers, KEY_MAX_PARALLEL_WORKERS);
 
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
+
+	// Memory limit for the hash join tables, zero means no limit
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashJoinMemoryLimit, KEY_HASH_JOIN_MEMORY_LIMIT, getInt);
+
+	// Memory limit for the hash aggregation groups, zero disables hash aggregation
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashAggregateMemoryLimit, KEY_HASH_AGGREGATE_MEMORY_LIMIT, getInt);
+
+	// Maximum depth of sequential read-ahead, zero disables read-ahead
+	CONFIG_GET_PER_DB_INT(getReadAheadPages, KEY_READ_AHEAD_PAGES);
+
+	// Preferred wire compression algorithm, zlib is used as fallback
+	CONFIG_GET_PER_DB_STR(getWireCompressionType, KEY_WIRE_COMPRESSION_TYPE);
+
+	// Level of outgoing wire compression, zero means default for the used algorithm
+	CONFIG_GET_PER_DB_INT(getWireCompressionLevel, KEY_WIRE_COMPRESSION_LEVEL);
 };
 
 // Implementation of interface to access master configuration file
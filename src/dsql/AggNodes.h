@@ -71,7 +71,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_COPYABLE_STATE;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -138,7 +138,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_COPYABLE_STATE;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -169,7 +169,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_COPYABLE_STATE;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
@@ -200,7 +200,7 @@ public:
 
 	virtual unsigned getCapabilities() const
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_COPYABLE_STATE;
 	}
 
 	virtual Firebird::string internalPrint(NodePrinter& printer) const;
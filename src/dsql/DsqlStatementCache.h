@@ -41,6 +41,12 @@ class Lock;
 class thread_db;
 
 
+// Cache of prepared DML statements of a single attachment.
+// It cannot be shared between attachments: compiled statements reference metadata objects
+// (jrd_rel, jrd_prc, dsql_rel, ...) owned by the attachment's own metadata cache and pools,
+// and access rights are verified against the attachment's user and roles.
+// The cache is kept on session reset, so pooled connections keep their prepared statements.
+
 class DsqlStatementCache final : public Firebird::PermanentStorage
 {
 private:
@@ -919,6 +919,8 @@ public:
 	static const unsigned CAP_WANTS_AGG_CALLS		= 0x04;
 	// wants winPass call in a window
 	static const unsigned CAP_WANTS_WIN_PASS_CALL	= 0x08;
+	// keeps its state in the impure_value_ex only, so it may be saved and restored by copying
+	static const unsigned CAP_COPYABLE_STATE		= 0x10;
 
 protected:
 	struct AggInfo
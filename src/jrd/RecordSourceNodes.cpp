@@ -1862,7 +1862,7 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 	// allocate and optimize the record source block
 
 	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
-		stream, (group ? &group->expressions : NULL), map, nextRsb);
+		stream, (group ? &group->expressions : NULL), map, nextRsb, groupOrdered);
 
 	if (rse->rse_aggregate)
 	{
@@ -527,7 +527,8 @@ public:
 		  group(NULL),
 		  map(NULL),
 		  rse(NULL),
-		  dsqlWindow(false)
+		  dsqlWindow(false),
+		  groupOrdered(false)
 	{
 	}
 
@@ -577,6 +578,7 @@ private:
 
 public:
 	bool dsqlWindow;
+	bool groupOrdered;	// the output order of the groups is used by the parent rse
 };
 
 class UnionSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_UNION>
@@ -274,6 +274,118 @@ bool BtrPageGCLock::isPageGCAllowed(thread_db* tdbb, const PageNumber& page)
 
 // IndexErrorContext class
 
+void BtrReadAhead::nextLeaf(thread_db* tdbb, const win* window)
+{
+/**************************************
+ *
+ *	B t r R e a d A h e a d : : n e x t L e a f
+ *
+ **************************************
+ *
+ * Functional description
+ *	Scan has moved to the next leaf page. Read ahead the
+ *	following leaves when the trigger page is reached.
+ *
+ **************************************/
+	if (!parent || (trigger && trigger != window->win_page.getPageNum()))
+		return;
+
+	Database* const dbb = tdbb->getDatabase();
+	const ULONG maxDepth = MIN((ULONG) dbb->dbb_config->getReadAheadPages(), PREFETCH_BATCH_PAGES);
+
+	if (!maxDepth)
+	{
+		parent = 0;
+		return;
+	}
+
+	depth = depth ? MIN((ULONG) depth * 2, maxDepth) : MIN((ULONG) READ_AHEAD_MIN_PAGES, maxDepth);
+
+	// The leaf is latched by caller, don't wait for the parent to avoid deadlock.
+	// Parent could be released and reused meanwhile, so check what we've got.
+
+	const btree_page* const leaf = (btree_page*) window->win_buffer;
+
+	WIN parentWindow(window->win_page.getPageSpaceID(), parent);
+	btree_page* const page = (btree_page*) CCH_FETCH_TIMEOUT(tdbb, &parentWindow, LCK_read,
+		pag_undefined, 0);
+
+	if (!page)
+	{
+		trigger = 0;
+		return;
+	}
+
+	if (page->btr_header.pag_type != pag_index || page->btr_level != 1 ||
+		page->btr_relation != leaf->btr_relation || page->btr_id != leaf->btr_id)
+	{
+		CCH_RELEASE(tdbb, &parentWindow);
+		parent = 0;
+		return;
+	}
+
+	HalfStaticArray<ULONG, PREFETCH_BATCH_PAGES> pages;
+	const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+	UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+	bool found = !last;
+	bool endBucket = false;
+	IndexNode node;
+
+	while (pages.getCount() < depth)
+	{
+		pointer = node.readNode(pointer, false);
+
+		if (pointer > endPointer || node.isEndLevel)
+			break;
+
+		if (node.isEndBucket)
+		{
+			endBucket = true;
+			break;
+		}
+
+		if (found)
+			pages.add(node.pageNumber);
+		else if (node.pageNumber == last)
+			found = true;
+	}
+
+	const ULONG sibling = page->btr_sibling;
+	CCH_RELEASE(tdbb, &parentWindow);
+
+	if (!found)
+	{
+		// Leaves were re-arranged since the scan was positioned
+		parent = 0;
+		return;
+	}
+
+	trigger = 0;
+
+	if (pages.isEmpty() && !endBucket)
+	{
+		parent = 0;
+		return;
+	}
+
+	if (pages.hasData())
+	{
+		last = pages.back();
+		trigger = pages[pages.getCount() / 2];
+
+		if (!CCH_prefetch_batch(tdbb, window->win_page.getPageSpaceID(), pages.begin(), pages.getCount()))
+			depth = 0;		// pages are cached already, start over with small batches
+	}
+
+	if (endBucket)
+	{
+		// Continue with the leaves of the next level 1 page
+		parent = sibling;
+		last = 0;
+	}
+}
+
+
 void IndexErrorContext::raise(thread_db* tdbb, idx_e result, Record* record)
 {
 	fb_assert(result != idx_e_ok);
@@ -1044,6 +1156,157 @@ bool BTR_description(thread_db* tdbb, jrd_rel* relation, index_root_page* root,
 }
 
 
+bool BTR_estimate_range(thread_db* tdbb, jrd_rel* relation, const index_desc* idx,
+						const dsc* lower, const dsc* upper, SSHORT scale, double& fraction)
+{
+/**************************************
+ *
+ *	B T R _ e s t i m a t e _ r a n g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Estimate the fraction of index entries between the given
+ *	bounds (inclusive, missing bound means open range) by
+ *	descending the index until the bounds fall into different
+ *	pages. Children are assumed to be equally filled.
+ *	Only single segment ascending indices are supported.
+ *	Return false if no estimation could be made.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	if (idx->idx_count != 1 || (idx->idx_flags & idx_descending))
+		return false;
+
+	const USHORT keyType = (idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+	const USHORT itype = idx->idx_rpt[0].idx_itype;
+
+	// Missing lower bound skips NULLs, see BTR_find_page()
+
+	temporary_key lowerKey, upperKey;
+	lowerKey.key_flags = upperKey.key_flags = 0;
+	lowerKey.key_length = upperKey.key_length = 0;
+	lowerKey.key_data[lowerKey.key_length++] = 0;
+
+	try
+	{
+		ThreadStatusGuard tempStatus(tdbb);
+
+		if (lower)
+			compress(tdbb, lower, scale, &lowerKey, itype, false, keyType, nullptr);
+
+		if (upper)
+			compress(tdbb, upper, scale, &upperKey, itype, false, keyType, nullptr);
+	}
+	catch (const Exception&)
+	{
+		// Bad value, let the retrieval report it
+		return false;
+	}
+
+	const auto compareKey = [](const UCHAR* data, USHORT length, const temporary_key& key)
+	{
+		const int result = memcmp(data, key.key_data, MIN(length, key.key_length));
+		return result ? result : (int) length - (int) key.key_length;
+	};
+
+	RelationPages* const relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, idx->idx_root);
+	btree_page* page = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+	UCHAR key[MAX_KEY];
+	double scope = 1;
+	bool result = false;
+
+	while (page->btr_header.pag_type == pag_index &&
+		page->btr_relation == relation->rel_id && page->btr_id == (UCHAR) (idx->idx_id % 256))
+	{
+		const bool leafPage = (page->btr_level == 0);
+		const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+
+		// Count nodes below the lower bound and up to the upper bound
+
+		ULONG count = 0, lowerPos = 0, upperPos = 0;
+		ULONG lowerPage = 0, upperPage = 0;
+		IndexNode node;
+		UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+
+		while (pointer < endPointer)
+		{
+			pointer = node.readNode(pointer, leafPage);
+
+			if (node.isEndBucket || node.isEndLevel || node.prefix + node.length > sizeof(key))
+				break;
+
+			memcpy(key + node.prefix, node.data, node.length);
+			const USHORT length = node.prefix + node.length;
+
+			if (compareKey(key, length, lowerKey) < 0)
+			{
+				lowerPos++;
+				lowerPage = node.pageNumber;
+			}
+
+			if (!upper || compareKey(key, length, upperKey) <= 0)
+			{
+				upperPos++;
+				upperPage = node.pageNumber;
+			}
+
+			count++;
+		}
+
+		if (!count)
+			break;
+
+		if (leafPage)
+		{
+			fraction = scope * (upperPos > lowerPos ? upperPos - lowerPos : 0) / count;
+			result = true;
+			break;
+		}
+
+		// Non-leaf node refers to the child which keys start from the node key
+
+		const ULONG lowerChild = lowerPos ? lowerPos - 1 : 0;
+		const ULONG upperChild = upperPos ? upperPos - 1 : 0;
+
+		if (lowerChild != upperChild)
+		{
+			// Children between the bounds are counted fully, the two outer ones
+			// containing the bounds by half each
+
+			fraction = (upperChild > lowerChild) ?
+				scope * ((upperChild - lowerChild - 1) + 0.5 + 0.5) / count : 0;
+			result = true;
+			break;
+		}
+
+		const ULONG child = lowerPos ? lowerPage : upperPage;
+
+		if (!child)
+		{
+			// Both bounds precede the first node, descend along the left edge
+			node.readNode(page->btr_nodes + page->btr_jump_size, false);
+
+			if (node.isEndBucket || node.isEndLevel)
+				break;
+
+			scope /= count;
+			page = (btree_page*) CCH_HANDOFF(tdbb, &window, node.pageNumber, LCK_read, pag_undefined);
+			continue;
+		}
+
+		scope /= count;
+		page = (btree_page*) CCH_HANDOFF(tdbb, &window, child, LCK_read, pag_undefined);
+	}
+
+	CCH_RELEASE(tdbb, &window);
+	return result;
+}
+
+
 dsc* BTR_eval_expression(thread_db* tdbb, index_desc* idx, Record* record)
 {
 	return IndexExpression(tdbb, idx).evaluate(record);
@@ -1161,11 +1424,12 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 
 	index_desc idx;
 	btree_page* page = nullptr;
+	BtrReadAhead readAhead;
 
 	do
 	{
 		if (!page) // scan from the index root
-			page = BTR_find_page(tdbb, retrieval, &window, &idx, lower, upper);
+			page = BTR_find_page(tdbb, retrieval, &window, &idx, lower, upper, &readAhead);
 
 		const bool descending = (idx.idx_flags & idx_descending);
 		bool skipLowerKey = (retrieval->irb_generic & ~forceInclFlag) & irb_exclude_lower;
@@ -1213,6 +1477,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 						skipLowerKey, *lower, forceInclFlag))
 			{
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				readAhead.nextLeaf(tdbb, &window);
 				pointer = page->btr_nodes + page->btr_jump_size;
 				prefix = 0;
 			}
@@ -1265,6 +1530,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				}
 
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				readAhead.nextLeaf(tdbb, &window);
 				endPointer = (UCHAR*) page + page->btr_length;
 				pointer = page->btr_nodes + page->btr_jump_size;
 				pointer = node.readNode(pointer, true);
@@ -1320,7 +1586,8 @@ btree_page* BTR_find_page(thread_db* tdbb,
 						  WIN* window,
 						  index_desc* idx,
 						  temporary_key* lower,
-						  temporary_key* upper)
+						  temporary_key* upper,
+						  BtrReadAhead* readAhead)
 {
 /**************************************
  *
@@ -1330,6 +1597,8 @@ btree_page* BTR_find_page(thread_db* tdbb,
  *
  * Functional description
  *	Initialize for an index retrieval.
+ *	If read-ahead state is passed, remember
+ *	the level 1 page of the found leaf.
  *
  **************************************/
 
@@ -1349,6 +1618,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 
 	btree_page* page = (btree_page*) CCH_HANDOFF(tdbb, window, idx->idx_root, LCK_read, pag_index);
 
+	if (readAhead)
+		readAhead->init(0, 0);
+
 	// If there is a starting descriptor, search down index to starting position.
 	// This may involve sibling buckets if splits are in progress.  If there
 	// isn't a starting descriptor, walk down the left side of the index (right
@@ -1378,6 +1650,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
 				if (number != END_BUCKET)
 				{
+					if (readAhead && page->btr_level == 1)
+						readAhead->init(window->win_page.getPageNum(), number);
+
 					page = (btree_page*) CCH_HANDOFF(tdbb, window, number, LCK_read, pag_index);
 					break;
 				}
@@ -1400,6 +1675,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 			if (pointer > endPointer)
 				BUGCHECK(204);	// msg 204 index inconsistent
 
+			if (readAhead && page->btr_level == 1)
+				readAhead->init(window->win_page.getPageNum(), node.pageNumber);
+
 			page = (btree_page*) CCH_HANDOFF(tdbb, window, node.pageNumber, LCK_read, pag_index);
 		}
 	}
@@ -50,6 +50,7 @@ class BtrPageGCLock;
 class Sort;
 class PartitionedSort;
 struct sort_key_def;
+struct win;
 
 // Index descriptor block -- used to hold info from index root page
 
@@ -305,6 +306,29 @@ struct IndexCreation
 	Firebird::AtomicCounter duplicates;
 };
 
+// Read-ahead of leaf pages for index range scans. The level 1 page which
+// points to the scanned leaves is remembered when the scan is positioned,
+// the following leaves are read ahead in growing batches while the scan
+// walks the leaf level. Zeroed state means no read-ahead.
+
+struct BtrReadAhead
+{
+	ULONG parent;			// level 1 page pointing to the scanned leaves
+	ULONG last;				// last leaf read ahead, zero to start from the parent's beginning
+	ULONG trigger;			// leaf which starts the next batch, zero for any
+	USHORT depth;			// size of the last batch
+
+	void init(ULONG parentPage, ULONG leafPage)
+	{
+		parent = parentPage;
+		last = leafPage;
+		trigger = 0;
+		depth = 0;
+	}
+
+	void nextLeaf(thread_db* tdbb, const win* window);
+};
+
 // Class used to report any index related errors
 
 class IndexErrorContext
@@ -133,11 +133,14 @@ static void prefetch_io(Prefetch*, FbStatusVector *);
 static void prefetch_prologue(Prefetch*, SLONG *);
 #endif
 static void cacheBuffer(Attachment* att, BufferDesc* bdb);
+extern "C" {
+	static int cmpBdbs(const void*, const void*);
+}
 static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
 static void down_grade(thread_db*, BufferDesc*, int high = 0);
 static bool expand_buffers(thread_db*, ULONG);
-static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int);
+static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int, bool);
 static int get_related(BufferDesc*, PagesArray&, int, const ULONG);
 static ULONG get_prec_walk_mark(BufferControl*);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
@@ -193,6 +196,9 @@ static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, F
 
 static void recentlyUsed(BufferDesc* bdb);
 static void requeueRecentlyUsed(BufferControl* bcb);
+static void lruRemove(BufferControl* bcb, BufferDesc* bdb);
+static void lruInsertHead(BufferControl* bcb, BufferDesc* bdb);
+static void lruInsertOld(BufferControl* bcb, BufferDesc* bdb, bool tail);
 
 
 const ULONG MIN_BUFFER_SEGMENT = 65536;
@@ -250,6 +256,7 @@ public:
 	BCBHashTable(MemoryPool& pool, ULONG count) :
 		m_pool(pool),
 		m_count(0),
+		m_shift(0),
 		m_chains(nullptr)
 	{
 		resize(count);
@@ -272,13 +279,19 @@ public:
 
 	void remove(BufferDesc* bdb);
 private:
+	// Fibonacci hashing: multiply the full page number (including page space)
+	// by 2^64 / golden ratio and take the top bits. It is much cheaper than
+	// modulo by an arbitrary number and doesn't put the same page numbers of
+	// different page spaces into the same chain.
 	ULONG hash(const PageNumber& pageno) const
 	{
-		return pageno.getPageNum() % m_count;
+		const FB_UINT64 key = ((FB_UINT64) pageno.getPageSpaceID() << 32) | pageno.getPageNum();
+		return (ULONG) ((key * FB_CONST64(0x9E3779B97F4A7C15)) >> m_shift);
 	}
 
 	MemoryPool& m_pool;
-	ULONG m_count;
+	ULONG m_count;			// number of chains, power of 2
+	unsigned m_shift;		// 64 - log2(m_count)
 	chain_type* m_chains;
 };
 
@@ -355,8 +368,8 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 		if (bdb->bdb_flags & BDB_lru_chained)
 			requeueRecentlyUsed(bcb);
 
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		lruRemove(bcb, bdb);
+		lruInsertOld(bcb, bdb, true);
 	}
 
 	bdb->release(tdbb, true);
@@ -715,7 +728,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	if (dbb->dbb_ast_flags & DBB_get_shadows)
 		SDW_get_shadows(tdbb);
 
-	BufferDesc* bdb = get_buffer(tdbb, window->win_page, SYNC_EXCLUSIVE, wait);
+	BufferDesc* bdb = get_buffer(tdbb, window->win_page, SYNC_EXCLUSIVE, wait, false);
 	if (!bdb)
 		return NULL;			// latch timeout occurred
 
@@ -753,7 +766,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= (BDB_lru_chained | BDB_lru_new | BDB_lru_old);	// yes, clear all except LRU state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -867,10 +880,13 @@ LockState CCH_fetch_lock(thread_db* tdbb, WIN* window, int lock_type, int wait,
 	if (dbb->dbb_ast_flags & DBB_get_shadows)
 		SDW_get_shadows(tdbb);
 
-	// Look for the page in the cache.
+	// Look for the page in the cache. Large scans and garbage collection
+	// touch pages once, don't let them push out the frequently used ones.
+
+	const bool lowPriority = (window->win_flags & (WIN_large_scan | WIN_garbage_collector));
 
 	BufferDesc* bdb = get_buffer(tdbb, window->win_page,
-		((lock_type >= LCK_write) ? SYNC_EXCLUSIVE : SYNC_SHARED), wait);
+		((lock_type >= LCK_write) ? SYNC_EXCLUSIVE : SYNC_SHARED), wait, lowPriority);
 
 	if (wait != 1 && bdb == 0)
 		return lsLatchTimeout; // latch timeout
@@ -1103,7 +1119,7 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 	{
 		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
 		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		lruRemove(bcb, bdb);
 	}
 
 	// remove from hash table and put into empty list
@@ -1605,6 +1621,9 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
 	QUE_INIT(bcb->bcb_in_use);
+	QUE_INIT(bcb->bcb_lru_midpoint);
+	QUE_INSERT(bcb->bcb_in_use, bcb->bcb_lru_midpoint);
+	bcb->bcb_lru_old_count = 0;
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
 	QUE_INIT(bcb->bcb_empty);
@@ -1845,6 +1864,129 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
+FB_SIZE_T CCH_prefetch_batch(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	C C H _ p r e f e t c h _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Bring a set of pages into the cache ahead of their use.
+ *	Pages already cached or busy are skipped, the rest are
+ *	read from disk by a single batched request. This is only
+ *	a hint: pages which were not read for any reason are left
+ *	for the regular fetch, which will also report the error.
+ *	Return the number of pages actually read.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!count || !bcb)
+		return 0;
+
+	PageSpace* const pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceId);
+	if (!pageSpace || !pageSpace->file)
+		return 0;
+
+	// Don't let a single prefetch occupy a noticeable part of the cache
+	const FB_SIZE_T maxPages = MIN(PREFETCH_BATCH_PAGES, bcb->bcb_count / 4);
+
+	HalfStaticArray<BufferDesc*, PREFETCH_BATCH_PAGES> bdbs;
+
+	for (const ULONG* const end = pages + count; pages < end && bdbs.getCount() < maxPages; pages++)
+	{
+		const PageNumber page(pageSpaceId, *pages);
+
+		{	// scope
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+			const BufferDesc* const bdb = bcb->bcb_hashTable->find(page);
+			if (bdb && !(bdb->bdb_flags & BDB_read_pending))
+				continue;
+		}
+
+		BufferDesc* const bdb = get_buffer(tdbb, page, SYNC_EXCLUSIVE, LCK_NO_WAIT, true);
+		if (!bdb)
+			continue;
+
+		bool mustRead;
+		if (bcb->bcb_flags & BCB_exclusive)
+			mustRead = (bdb->bdb_flags & BDB_read_pending);
+		else
+		{
+			const LockState lockState = lock_buffer(tdbb, bdb, LCK_NO_WAIT, pag_undefined);
+			if (lockState == lsLockTimeout)
+				continue;		// buffer is released already
+
+			mustRead = (lockState == lsLocked);
+		}
+
+		if (mustRead)
+			bdbs.add(bdb);
+		else
+			bdb->release(tdbb, true);
+	}
+
+	if (bdbs.isEmpty())
+		return 0;
+
+	qsort(bdbs.begin(), bdbs.getCount(), sizeof(BufferDesc*), cmpBdbs);
+
+	FbLocalStatus status;
+	bool result = false;
+
+	BackupManager::StateReadGuard stateGuard(tdbb);
+
+	// Pages which could be in the difference file are read by CCH_fetch_page
+
+	if (pageSpace->isTemporary() || dbb->dbb_backup_manager->getState() == Ods::hdr_nbak_normal)
+		result = PIO_read_batch(tdbb, pageSpace->file, bdbs.begin(), bdbs.getCount(), &status);
+
+	// Page images are read already, let crypto manager decrypt them
+
+	class NoIo : public CryptoManager::IOCallback
+	{
+	public:
+		bool callback(thread_db*, FbStatusVector*, Ods::pag*)
+		{
+			return true;
+		}
+	} noIo;
+
+	FB_SIZE_T read = 0;
+
+	for (BufferDesc** iter = bdbs.begin(); iter != bdbs.end(); ++iter)
+	{
+		BufferDesc* const bdb = *iter;
+		pag* const page = bdb->bdb_buffer;
+
+		if (result && dbb->dbb_crypto_manager->read(tdbb, &status, page, &noIo) &&
+			page->pag_pageno == bdb->bdb_page.getPageNum())
+		{
+			bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+			bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending);
+			bdb->bdb_flags |= BDB_prefetch;
+			tdbb->bumpStats(RuntimeStatistics::PAGE_READS);
+			read++;
+		}
+		else
+		{
+			// Leave the buffer as not read, next fetch will read it again
+			PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+		}
+
+		bdb->release(tdbb, true);
+	}
+
+	return read;
+}
+
+
 #ifdef CACHE_READER
 void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
 {
@@ -2125,8 +2267,8 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 						requeueRecentlyUsed(bcb);
 					}
 
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					lruRemove(bcb, bdb);
+					lruInsertOld(bcb, bdb, true);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
@@ -2585,6 +2727,9 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 		if (bdb->bdb_flags & BDB_garbage_collect)
 			bdb->bdb_flags &= ~BDB_garbage_collect;
 	}
+
+	if (bdb->bdb_flags & BDB_prefetch)
+		bdb->bdb_flags &= ~BDB_prefetch;
 }
 
 
@@ -3625,6 +3770,9 @@ static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 	for (QUE que_inst = bcb->bcb_in_use.que_backward;
 		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
 	{
+		if (que_inst == &bcb->bcb_lru_midpoint)
+			continue;
+
 		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
@@ -3693,6 +3841,9 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
 			BUGCHECK(213);	// msg 213 insufficient cache size
 
+		if (que_inst == &bcb->bcb_lru_midpoint)
+			continue;
+
 		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
 		if (oldest->bdb_flags & BDB_lru_chained)
@@ -3771,7 +3922,8 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 }
 
 
-static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait)
+static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait,
+	bool lowPriority)
 {
 /**************************************
  *
@@ -3792,6 +3944,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
  *			0 => If the lock can't be acquired immediately,
  *				give up and return 0;
  *			<negative number> => Latch timeout interval in seconds.
+ *	lowPriority:	page is referenced by a scan, don't move it to
+ *				the head of LRU que.
  *
  * return
  *	BufferDesc pointer if successful.
@@ -3812,7 +3966,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			{
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					if (!lowPriority)
+						recentlyUsed(bdb);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					return bdb;
 				}
@@ -3855,7 +4010,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				// ensure the found page buffer is still for the same page after latch
 				if (bdb->bdb_page == page)
 				{
-					recentlyUsed(bdb);
+					if (!lowPriority)
+						recentlyUsed(bdb);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3895,7 +4051,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				else if (bdb->bdb_page == page)
 				{
 					bdb->downgrade(syncType);
-					recentlyUsed(bdb);
+					if (!lowPriority)
+						recentlyUsed(bdb);
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3919,7 +4076,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (!bdb2)
 				{
 					bdb->bdb_page = page;
-					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+					bdb->bdb_flags &= (BDB_lru_chained | BDB_lru_new | BDB_lru_old); // yes, clear all except LRU state
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
 					if (bdb->bdb_lock)
@@ -3929,17 +4086,25 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
+					// New page enters the cache at the LRU midpoint, it will be moved
+					// to the LRU head when referenced again
+
 					if (!(bdb->bdb_flags & BDB_lru_chained))
 					{
 						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
 						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
 						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+							lruRemove(bcb, bdb);
+							lruInsertOld(bcb, bdb, false);
 						}
 						else
+						{
+							bdb->bdb_flags |= BDB_lru_new;
 							recentlyUsed(bdb);
+						}
 					}
+					else
+						bdb->bdb_flags |= BDB_lru_new;
 					tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3957,7 +4122,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bdb2->release(tdbb, true);
 					continue;
 				}
-				recentlyUsed(bdb2);
+				if (!lowPriority)
+					recentlyUsed(bdb2);
 				tdbb->bumpStats(RuntimeStatistics::PAGE_FETCHES);
 				cacheBuffer(att, bdb2);
 			}
@@ -4548,7 +4714,7 @@ static void prefetch_prologue(Prefetch* prefetch, SLONG* start_page)
 	{
 		*next_bdb = 0;
 		if (SBM_clear(bcb->bcb_prefetch, *start_page) &&
-			(*next_bdb = get_buffer(tdbb, *start_page, LATCH_shared, 0)))
+			(*next_bdb = get_buffer(tdbb, *start_page, LATCH_shared, 0, true)))
 		{
 			if ((*next_bdb)->bdb_flags & BDB_read_pending)
 				prefetch->prf_page_count = i + 1;
@@ -5146,8 +5312,15 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+		lruRemove(bcb, bdb);
+
+		if (bdb->bdb_flags & BDB_lru_new)
+		{
+			bdb->bdb_flags &= ~BDB_lru_new;
+			lruInsertOld(bcb, bdb, false);
+		}
+		else
+			lruInsertHead(bcb, bdb);
 
 		bdb->bdb_lru_chain = NULL;
 		bdb->bdb_flags &= ~BDB_lru_chained;
@@ -5157,6 +5330,69 @@ void requeueRecentlyUsed(BufferControl* bcb)
 }
 
 
+// LRU que is split by bcb_lru_midpoint into two parts. New pages are put
+// into the old part, at the midpoint, and are moved to the LRU head only
+// when referenced again by a regular fetch. Pages released by large scans
+// are put at the LRU tail. Thus a scan can't push out frequently used pages:
+// it recycles buffers of the old part only. When the old part becomes
+// smaller than LRU_OLD_PERCENT of the cache, least recently used pages of the
+// new part are moved into it. All routines below require bcb_syncLRU to be
+// locked exclusively.
+
+void lruRemove(BufferControl* bcb, BufferDesc* bdb)
+{
+	QUE_DELETE(bdb->bdb_in_use);
+	QUE_INIT(bdb->bdb_in_use);
+
+	if (bdb->bdb_flags & BDB_lru_old)
+	{
+		bdb->bdb_flags &= ~BDB_lru_old;
+		fb_assert(bcb->bcb_lru_old_count);
+		bcb->bcb_lru_old_count--;
+	}
+}
+
+
+void lruInsertHead(BufferControl* bcb, BufferDesc* bdb)
+{
+	fb_assert(!(bdb->bdb_flags & BDB_lru_old));
+	QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+	// Keep the old part of LRU at its target size by moving the midpoint
+	// towards the LRU head
+
+	const ULONG oldTarget = (ULONG) ((FB_UINT64) bcb->bcb_count * LRU_OLD_PERCENT / 100);
+
+	while (bcb->bcb_lru_old_count < oldTarget)
+	{
+		const QUE que_inst = bcb->bcb_lru_midpoint.que_backward;
+		if (que_inst == &bcb->bcb_in_use)
+			break;
+
+		QUE_DELETE(bcb->bcb_lru_midpoint);
+		QUE_APPEND(*que_inst, bcb->bcb_lru_midpoint);
+
+		BufferDesc* const demoted = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		demoted->bdb_flags |= BDB_lru_old;
+		bcb->bcb_lru_old_count++;
+	}
+}
+
+
+void lruInsertOld(BufferControl* bcb, BufferDesc* bdb, bool tail)
+{
+	fb_assert(!(bdb->bdb_flags & BDB_lru_old));
+
+	if (tail)
+		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+	else
+		QUE_INSERT(bcb->bcb_lru_midpoint, bdb->bdb_in_use);
+
+	bdb->bdb_flags |= BDB_lru_old;
+	bcb->bcb_lru_old_count++;
+}
+
+
 BufferControl* BufferControl::create(Database* dbb)
 {
 	MemoryPool* const pool = dbb->createPool();
@@ -5303,8 +5539,16 @@ void BCBHashTable::resize(ULONG count)
 	const ULONG old_count = m_count;
 	chain_type* const old_chains = m_chains;
 
+	// Round number of chains up to the power of 2, see hash()
+
+	unsigned bits = 1;
+	while (bits < 31 && (1u << bits) < count)
+		bits++;
+	count = 1u << bits;
+
 	chain_type* new_chains = FB_NEW_POOL(m_pool) chain_type[count];
 	m_count = count;
+	m_shift = 64 - bits;
 	m_chains = new_chains;
 
 #ifndef HASH_USE_CDS_LIST
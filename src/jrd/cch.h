@@ -86,6 +86,8 @@ class BufferControl : public pool_alloc<type_bcb>
 	{
 		bcb_database = NULL;
 		QUE_INIT(bcb_in_use);
+		QUE_INIT(bcb_lru_midpoint);
+		QUE_INSERT(bcb_in_use, bcb_lru_midpoint);
 		QUE_INIT(bcb_pending);
 		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
@@ -95,6 +97,7 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_free_minimum = 0;
 		bcb_count = 0;
 		bcb_inuse = 0;
+		bcb_lru_old_count = 0;
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
@@ -116,6 +119,7 @@ public:
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
 	que			bcb_in_use;			// Que of buffers in use, main LRU que
+	que			bcb_lru_midpoint;	// Marker in bcb_in_use, buffers after it form the old part of LRU
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
 	que			bcb_empty;			// Que of empty buffers
 
@@ -132,6 +136,7 @@ public:
 	SSHORT		bcb_free_minimum;	// Threshold to activate cache writer
 	ULONG		bcb_count;			// Number of buffers allocated
 	ULONG		bcb_inuse;			// Number of buffers in use
+	ULONG		bcb_lru_old_count;	// Number of buffers in the old part of LRU
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
@@ -279,14 +284,14 @@ const int BDB_writer			= 0x0004;	// someone is updating the page
 const int BDB_marked			= 0x0008;	// page has been updated
 const int BDB_must_write		= 0x0010;	// forces a write as soon as the page is released
 const int BDB_faked				= 0x0020;	// page was just allocated
-//const int BDB_merge			= 0x0040;
+const int BDB_lru_new			= 0x0040;	// chained buffer is to be queued at the LRU midpoint
 const int BDB_system_dirty 		= 0x0080;	// system transaction has marked dirty
 const int BDB_io_error	 		= 0x0100;	// page i/o error
 const int BDB_read_pending 		= 0x0200;	// read is pending
 const int BDB_free_pending 		= 0x0400;	// buffer being freed for reuse
 const int BDB_not_valid			= 0x0800;	// i/o error invalidated buffer
 const int BDB_db_dirty 			= 0x1000;	// page must be written to database
-//const int BDB_checkpoint		= 0x2000;	// page must be written by next checkpoint
+const int BDB_lru_old			= 0x2000;	// buffer is in the old part of LRU que
 const int BDB_prefetch			= 0x4000;	// page has been prefetched but not yet referenced
 const int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 const int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
@@ -347,6 +352,17 @@ enum LATCH
 };
 
 
+// Maximum number of pages read by one CCH_prefetch_batch() call
+const FB_SIZE_T PREFETCH_BATCH_PAGES = 64;
+
+// Initial depth of sequential read-ahead
+const USHORT READ_AHEAD_MIN_PAGES = 4;
+
+// Share of the cache kept in the old part of LRU que, in percents.
+// Newly read pages enter the cache there and reach the head of the
+// LRU only when referenced again by a regular (not scan) fetch.
+const ULONG LRU_OLD_PERCENT = 37;
+
 
 #ifdef SUPERSERVER_V2
 #include "../jrd/os/pio.h"
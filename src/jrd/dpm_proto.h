@@ -75,6 +75,7 @@ void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
 SLONG	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::PageBitmap*, SLONG);
 #endif
 ULONG	DPM_pointer_pages(Jrd::thread_db*, Jrd::jrd_rel*);
+void	DPM_read_ahead_bitmap(Jrd::thread_db*, Jrd::record_param*, Jrd::RecordBitmap*);
 void	DPM_scan_pages(Jrd::thread_db*);
 void	DPM_store(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack&, const Jrd::RecordStorageType type);
 RecordNumber DPM_store_blob(Jrd::thread_db*, Jrd::blb*, Jrd::Record*);
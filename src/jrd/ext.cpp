@@ -69,13 +69,10 @@ __int64 __cdecl _ftelli64(FILE*);
 #endif
 
 #ifdef WIN_NT
-#define FTELL64 _ftelli64
 #define FSEEK64 _fseeki64
 #elif defined(LSB_BUILD)
-#define FTELL64 ftello64
 #define FSEEK64 fseeko64
 #else
-#define FTELL64 ftello
 #define FSEEK64 fseeko
 #endif
 
@@ -153,8 +150,28 @@ namespace {
 			}
 		}
 
+		// Default stdio buffer is a few KB, so scans of big files cost a read call per few rows
+
+		if (!ext_file->ext_buffer)
+			ext_file->ext_buffer = FB_NEW_POOL(*dbb->dbb_permanent) char[EXT_BUFFER_SIZE];
+
+		setvbuf(ext_file->ext_ifi, ext_file->ext_buffer, _IOFBF, EXT_BUFFER_SIZE);
+
 		return ext_file->ext_ifi;
 	}
+
+	void ext_fclose(ExternalFile* ext_file)
+	{
+		if (ext_file->ext_ifi)
+		{
+			fclose(ext_file->ext_ifi);
+			ext_file->ext_ifi = NULL;
+		}
+
+		delete[] ext_file->ext_buffer;
+		ext_file->ext_buffer = NULL;
+		ext_file->ext_flags &= ~(EXT_last_write | EXT_last_read);
+	}
 } // namespace
 
 
@@ -196,10 +213,7 @@ double EXT_cardinality(thread_db* tdbb, jrd_rel* relation)
 		}
 
 		if (must_close)
-		{
-			fclose(file->ext_ifi);
-			file->ext_ifi = NULL;
-		}
+			ext_fclose(file);
 
 		const Format* const format = MET_current(tdbb, relation);
 		fb_assert(format && format->fmt_length);
@@ -309,6 +323,8 @@ ExternalFile* EXT_file(jrd_rel* relation, const TEXT* file_name) //, bid* descri
 	strcpy(file->ext_filename, file_name);
 	file->ext_flags = 0;
 	file->ext_ifi = NULL;
+	file->ext_buffer = NULL;
+	file->ext_position = 0;
 
 	return file;
 }
@@ -329,11 +345,7 @@ void EXT_fini(jrd_rel* relation, bool close_only)
 	if (relation->rel_file)
 	{
 		ExternalFile* file = relation->rel_file;
-		if (file->ext_ifi)
-		{
-			fclose(file->ext_ifi);
-			file->ext_ifi = NULL;
-		}
+		ext_fclose(file);
 
 		// before zeroing out the rel_file we need to deallocate the memory
 		if (!close_only)
@@ -377,23 +389,10 @@ bool EXT_get(thread_db* tdbb, record_param* rpb, FB_UINT64& position)
 
 	// hvlad: fseek will flush file buffer and degrade performance, so don't
 	// call it if it is not necessary. Note that we must flush file buffer if we
-	// do read after write
+	// do read after write. The position after the last read is remembered to
+	// avoid asking the stream for it on every row.
 
-	bool doSeek = false;
-	if (!(file->ext_flags & EXT_last_read))
-	{
-		doSeek = true;
-	}
-	else
-	{
-		SINT64 offset = FTELL64(file->ext_ifi);
-		if (offset < 0)
-		{
-			ERR_post(Arg::Gds(isc_io_error) << STRINGIZE(FTELL64) << Arg::Str(file->ext_filename) <<
-					 Arg::Gds(isc_io_read_err) << SYS_ERR(errno));
-		}
-		doSeek = (static_cast<FB_UINT64>(offset) != position);
-	}
+	const bool doSeek = !(file->ext_flags & EXT_last_read) || file->ext_position != position;
 
 	// reset both flags cause we are going to move the file pointer
 	file->ext_flags &= ~(EXT_last_write | EXT_last_read);
@@ -413,6 +412,7 @@ bool EXT_get(thread_db* tdbb, record_param* rpb, FB_UINT64& position)
 	}
 
 	position += l;
+	file->ext_position = position;
 	file->ext_flags |= EXT_last_read;
 
 	// Loop thru fields setting missing fields to either blanks/zeros or the missing value
@@ -610,9 +610,6 @@ void EXT_tra_detach(ExternalFile* file, jrd_tra*)
  **************************************/
 
 	file->ext_tra_cnt--;
-	if (!file->ext_tra_cnt && file->ext_ifi)
-	{
-		fclose(file->ext_ifi);
-		file->ext_ifi = NULL;
-	}
+	if (!file->ext_tra_cnt)
+		ext_fclose(file);
 }
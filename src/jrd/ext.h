@@ -36,6 +36,8 @@ public:
 	USHORT	ext_flags;			// Misc and cruddy flags
 	USHORT	ext_tra_cnt;		// How many transactions used the file
 	FILE*	ext_ifi;			// Internal file identifier
+	char*	ext_buffer;			// stdio buffer of ext_ifi
+	FB_UINT64 ext_position;		// File position after the last read
 	char	ext_filename[1];
 };
 
@@ -43,6 +45,8 @@ const int EXT_readonly		= 1;	// File could only be opened for read
 const int EXT_last_read		= 2;	// last operation was read
 const int EXT_last_write	= 4;	// last operation was write
 
+const size_t EXT_BUFFER_SIZE = 256 * 1024;	// stdio buffer size, rows are read one by one
+
 } //namespace Jrd
 
 #endif // JRD_EXT_H
@@ -1763,6 +1763,7 @@ void Optimizer::checkSorts()
 			{
 				setDirection(project, group);
 				project = rse->rse_projection = nullptr;
+				aggregate->groupOrdered = true;
 			}
 		}
 
@@ -1793,6 +1794,7 @@ void Optimizer::checkSorts()
 				setDirection(sort, group);
 				setPosition(sort, group, map);
 				sort = rse->rse_sorted = nullptr;
+				aggregate->groupOrdered = true;
 			}
 		}
 	}
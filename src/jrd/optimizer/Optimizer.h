@@ -695,6 +695,7 @@ protected:
 	bool checkIndexExpression(const index_desc* idx, ValueExprNode* node) const;
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
+	bool estimateRange(const IndexScratch& scratch, double& selectivity) const;
 	const Firebird::string& getAlias();
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
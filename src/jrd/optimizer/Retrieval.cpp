@@ -232,6 +232,54 @@ InversionNode* Retrieval::composeInversion(InversionNode* node1,
 	return FB_NEW_POOL(getPool()) InversionNode(node_type, node1, node2);
 }
 
+//
+// Estimate selectivity of an index scan bounded by constants using the index pages
+//
+
+bool Retrieval::estimateRange(const IndexScratch& scratch, double& selectivity) const
+{
+	// Only a single segment index compared with constants is supported.
+	// The estimation is a fraction of the index entries, it cannot be used
+	// for a partial index as the share of the table rows it contains is unknown.
+
+	const auto idx = scratch.index;
+
+	if (idx->idx_count != 1 || (idx->idx_flags & idx_condition) || scratch.segments.isEmpty())
+		return false;
+
+	const auto& segment = scratch.segments[0];
+
+	switch (segment.scanType)
+	{
+		case segmentScanEqual:
+		case segmentScanBetween:
+		case segmentScanLess:
+		case segmentScanGreater:
+			break;
+
+		default:
+			return false;
+	}
+
+	const ValueExprNode* const values[2] = {segment.lowerValue, segment.upperValue};
+	const dsc* bounds[2] = {nullptr, nullptr};
+
+	for (unsigned i = 0; i < 2; i++)
+	{
+		if (!values[i])
+			continue;
+
+		const auto literal = nodeAs<LiteralNode>(values[i]);
+
+		if (!literal || (literal->litDesc.dsc_flags & DSC_null))
+			return false;
+
+		bounds[i] = &literal->litDesc;
+	}
+
+	return BTR_estimate_range(tdbb, relation, idx, bounds[0], bounds[1], segment.scale, selectivity);
+}
+
 const string& Retrieval::getAlias()
 {
 	if (alias.isEmpty())
@@ -1091,6 +1139,16 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				}
 			}
 
+			// Average selectivity doesn't reflect skewed data, so estimate
+			// comparisons with constants using the index itself
+
+			double estimated;
+			if (scratch.scopeCandidate && !unique && !listCount && !scratch.usePartialKey &&
+				estimateRange(scratch, estimated))
+			{
+				scratch.selectivity = MAX(estimated, minSelectivity);
+			}
+
 			if (scratch.scopeCandidate)
 			{
 				double selectivity = scratch.selectivity;
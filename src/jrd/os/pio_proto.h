@@ -50,6 +50,8 @@ USHORT	PIO_init_data(Jrd::thread_db*, Jrd::jrd_file*, Jrd::FbStatusVector*, ULON
 Jrd::jrd_file*	PIO_open(Jrd::thread_db*, const Firebird::PathName&,
 						 const Firebird::PathName&);
 bool	PIO_read(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
+bool	PIO_read_batch(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc* const*, FB_SIZE_T,
+					   Jrd::FbStatusVector*);
 
 #ifdef SUPERSERVER_V2
 bool	PIO_read_ahead(Jrd::thread_db*, SLONG, SCHAR*, SLONG,
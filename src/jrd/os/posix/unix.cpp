@@ -48,6 +48,13 @@
 #ifdef HAVE_LINUX_FALLOC_H
 #include <linux/falloc.h>
 #endif
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+#if defined(HAVE_LIBURING_H) && defined(HAVE_LIBURING)
+#include <liburing.h>
+#define USE_IO_URING
+#endif
 
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
@@ -90,6 +97,9 @@ using namespace Firebird;
 
 #define IO_RETRY	20
 
+// Maximum number of page reads submitted together by PIO_read_batch()
+const unsigned BATCH_IO_DEPTH = 64;
+
 #ifdef O_SYNC
 #define SYNC		O_SYNC
 #endif
@@ -132,7 +142,62 @@ using namespace Firebird;
 
 static const mode_t MASK = 0660;
 
+namespace
+{
+	struct PageRead
+	{
+		jrd_file* file;
+		FB_UINT64 offset;
+		Ods::pag* page;
+	};
+
+#ifdef USE_IO_URING
+	// Per-thread io_uring instance used by PIO_read_batch(). The ring setup
+	// is not cheap, so it's created on first use by a thread and kept until
+	// the thread exits. If the kernel refuses to create the ring (old kernel,
+	// seccomp filter, memlock limit) readv-style I/O is used instead.
+
+	class ThreadRing
+	{
+	public:
+		ThreadRing()
+			: ready(io_uring_queue_init(BATCH_IO_DEPTH, &ring, 0) == 0)
+		{ }
+
+		~ThreadRing()
+		{
+			release();
+		}
+
+		io_uring* get()
+		{
+			return ready ? &ring : NULL;
+		}
+
+		void release()
+		{
+			if (ready)
+			{
+				io_uring_queue_exit(&ring);
+				ready = false;
+			}
+		}
+
+	private:
+		io_uring ring;
+		bool ready;
+	};
+
+	thread_local ThreadRing threadRing;
+#endif
+}
+
 static jrd_file* seek_file(jrd_file*, BufferDesc*, FB_UINT64*, FbStatusVector*);
+static bool read_run(const PageRead*, FB_SIZE_T, SLONG, FbStatusVector*);
+#ifdef USE_IO_URING
+static bool uring_read(io_uring*, const PageRead*, FB_SIZE_T, SLONG);
+static bool uring_wait(io_uring*, unsigned, SLONG);
+#endif
 static jrd_file* setup_file(Database*, const PathName&, int, USHORT);
 static void lockDatabaseFile(int& desc, const bool shareMode, const bool temporary,
 							 const char* fileName, ISC_STATUS operation);
@@ -837,6 +902,68 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, BufferDesc* const* bdbs, FB_SIZE_T count,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of data pages at once. With io_uring all reads
+ *	are queued to the kernel together, otherwise every run of
+ *	adjacent pages is read by a single preadv() call. Buffers
+ *	are expected to be sorted by page number. Return false if
+ *	any page was not read completely, the caller is expected
+ *	to read such buffers one by one with PIO_read().
+ *
+ **************************************/
+	if (file->fil_desc == -1)
+		return unix_error("read", file, isc_io_read_err, status_vector);
+
+	Database* const dbb = tdbb->getDatabase();
+	const SLONG size = dbb->dbb_page_size;
+
+	HalfStaticArray<PageRead, BATCH_IO_DEPTH> reads;
+	PageRead* const ptr = reads.getBuffer(count);
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		if (!(ptr[i].file = seek_file(file, bdbs[i], &ptr[i].offset, status_vector)))
+			return false;
+
+		ptr[i].page = bdbs[i]->bdb_buffer;
+	}
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+#ifdef USE_IO_URING
+	if (io_uring* const ring = threadRing.get())
+		return uring_read(ring, ptr, count, size);
+#endif
+
+	for (FB_SIZE_T n = 0; n < count;)
+	{
+		FB_SIZE_T run = 1;
+		while (n + run < count && run < BATCH_IO_DEPTH &&
+			ptr[n + run].file == ptr[n].file &&
+			ptr[n + run].offset == ptr[n].offset + (FB_UINT64) run * size)
+		{
+			run++;
+		}
+
+		if (!read_run(ptr + n, run, size, status_vector))
+			return false;
+
+		n += run;
+	}
+
+	return true;
+}
+
+
 bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page, FbStatusVector* status_vector)
 {
 /**************************************
@@ -931,6 +1058,175 @@ static jrd_file* seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 }
 
 
+static bool read_run(const PageRead* reads, FB_SIZE_T count, SLONG size,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	r e a d _ r u n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a run of pages adjacent in the same file.
+ *	Short read is not an error here, just return false.
+ *
+ **************************************/
+	jrd_file* const file = reads->file;
+
+#if defined(HAVE_PREADV) && !defined(LSB_BUILD)
+	struct iovec iov[BATCH_IO_DEPTH];
+	fb_assert(count <= BATCH_IO_DEPTH);
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		iov[i].iov_base = reads[i].page;
+		iov[i].iov_len = size;
+	}
+
+	const SINT64 length = (SINT64) size * count;
+
+	for (int i = 0; i < IO_RETRY; i++)
+	{
+		const SINT64 bytes = preadv(file->fil_desc, iov, count, LSEEK_OFFSET_CAST reads->offset);
+
+		if (bytes == length)
+			return true;
+
+		if (bytes >= 0)
+			return false;
+
+		if (!SYSCALL_INTERRUPTED(errno))
+			return unix_error("preadv", file, isc_io_read_err, status_vector);
+	}
+
+	return unix_error("read_retry", file, isc_io_read_err, status_vector);
+#else
+	for (FB_SIZE_T n = 0; n < count; n++)
+	{
+		int i;
+		for (i = 0; i < IO_RETRY; i++)
+		{
+			const SINT64 bytes = os_utils::pread(file->fil_desc, reads[n].page, size,
+				LSEEK_OFFSET_CAST reads[n].offset);
+
+			if (bytes == size)
+				break;
+
+			if (bytes >= 0)
+				return false;
+
+			if (!SYSCALL_INTERRUPTED(errno))
+				return unix_error("read", file, isc_io_read_err, status_vector);
+		}
+
+		if (i == IO_RETRY)
+			return unix_error("read_retry", file, isc_io_read_err, status_vector);
+	}
+
+	return true;
+#endif
+}
+
+
+#ifdef USE_IO_URING
+static bool uring_read(io_uring* ring, const PageRead* reads, FB_SIZE_T count, SLONG size)
+{
+/**************************************
+ *
+ *	u r i n g _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Queue page reads to the ring and wait for all of them.
+ *	Errors are not reported, a false result makes the caller
+ *	repeat the reads in the regular way.
+ *
+ **************************************/
+	bool result = true;
+
+	for (FB_SIZE_T n = 0; n < count;)
+	{
+		const unsigned depth = MIN(count - n, BATCH_IO_DEPTH);
+
+		for (unsigned i = 0; i < depth; i++)
+		{
+			const PageRead& read = reads[n + i];
+			io_uring_sqe* const sqe = io_uring_get_sqe(ring);
+			fb_assert(sqe);
+			io_uring_prep_read(sqe, read.file->fil_desc, read.page, size, read.offset);
+		}
+
+		int submitted;
+		do
+		{
+			submitted = io_uring_submit(ring);
+		} while (submitted == -EINTR);
+
+		if (submitted < (int) depth)
+		{
+			// Part of the batch never reached the kernel. Wait for submitted reads and drop
+			// the ring, else the rest could be submitted later into buffers no longer ours.
+
+			if (submitted > 0)
+				uring_wait(ring, submitted, size);
+
+			threadRing.release();
+			return false;
+		}
+
+		if (!uring_wait(ring, depth, size))
+			result = false;
+
+		n += depth;
+	}
+
+	return result;
+}
+
+
+static bool uring_wait(io_uring* ring, unsigned count, SLONG size)
+{
+/**************************************
+ *
+ *	u r i n g _ w a i t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Reap given number of completions, return true
+ *	if all of them have read the whole page.
+ *
+ **************************************/
+	bool result = true;
+
+	while (count)
+	{
+		io_uring_cqe* cqe;
+		const int rc = io_uring_wait_cqe(ring, &cqe);
+
+		if (rc == -EINTR || rc == -EAGAIN)
+			continue;
+
+		if (rc < 0)
+		{
+			fb_assert(false);
+			return false;
+		}
+
+		if (cqe->res != size)
+			result = false;
+
+		io_uring_cqe_seen(ring, cqe);
+		count--;
+	}
+
+	return result;
+}
+#endif // USE_IO_URING
+
+
 static int openFile(const PathName& name, const bool forceWrite,
 	const bool notUseFSCache, const bool readOnly)
 {
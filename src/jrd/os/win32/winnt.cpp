@@ -610,6 +610,29 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, BufferDesc* const* bdbs, FB_SIZE_T count,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of data pages.
+ *
+ **************************************/
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		if (!PIO_read(tdbb, file, bdbs[i], bdbs[i]->bdb_buffer, status_vector))
+			return false;
+	}
+
+	return true;
+}
+
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
@@ -18,12 +18,16 @@
  */
 
 #include "firebird.h"
+#include "../common/classes/Aligner.h"
+#include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
+#include "../jrd/intl.h"
 #include "../dsql/Nodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/exe_proto.h"
+#include "../jrd/intl_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/Attachment.h"
@@ -64,6 +68,14 @@ BaseAggWinStream<ThisType, NextType>::BaseAggWinStream(thread_db* tdbb, Compiler
 
 template <typename ThisType, typename NextType>
 void BaseAggWinStream<ThisType, NextType>::internalOpen(thread_db* tdbb) const
+{
+	initImpure(tdbb);
+
+	m_next->open(tdbb);
+}
+
+template <typename ThisType, typename NextType>
+void BaseAggWinStream<ThisType, NextType>::initImpure(thread_db* tdbb) const
 {
 	Request* const request = tdbb->getRequest();
 	Impure* const impure = getImpure(request);
@@ -81,8 +93,6 @@ void BaseAggWinStream<ThisType, NextType>::internalOpen(thread_db* tdbb) const
 		impure->groupValues = FB_NEW_POOL(*tdbb->getDefaultPool()) impure_value[impureCount];
 		memset(impure->groupValues, 0, sizeof(impure_value) * impureCount);
 	}
-
-	m_next->open(tdbb);
 }
 
 template <typename ThisType, typename NextType>
@@ -366,41 +376,290 @@ bool BaseAggWinStream<ThisType, NextType>::getNextRecord(thread_db* tdbb, Reques
 // Export the template for WindowedStream::WindowStream.
 template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedStream>;
 
+// ------------------------------------
+// Data access: hash aggregation groups
+// ------------------------------------
+
+// Every group is kept in a single entry consisting of the header, the group key,
+// the aggregated record data and the saved states of the aggregate functions.
+// Entries are allocated from blocks and chained into the dynamically sized buckets.
+
+static const ULONG GROUP_BLOCK_SIZE = 64 * 1024;
+static const ULONG GROUP_LOAD_FACTOR = 2;
+static const ULONG GROUP_MIN_BUCKETS = 64;
+
+class AggregatedStream::HashTable : public PermanentStorage
+{
+	struct Entry
+	{
+		ULONG next;
+		ULONG hash;
+	};
+
+	static const ULONG END_OF_CHAIN = MAX_ULONG;
+
+public:
+	HashTable(MemoryPool& pool, ULONG keyLength, ULONG dataLength, ULONG stateLength,
+			  FB_UINT64 memoryLimit)
+		: PermanentStorage(pool),
+		  m_keyLength(keyLength),
+		  m_dataOffset(getDataOffset(keyLength)),
+		  m_stateOffset(m_dataOffset + FB_ALIGN(dataLength, FB_ALIGNMENT)),
+		  m_entryLength(getEntrySize(keyLength, dataLength, stateLength)),
+		  m_memoryLimit(memoryLimit),
+		  m_memoryUsed(0),
+		  m_blocks(pool),
+		  m_blockFree(0),
+		  m_groups(pool),
+		  m_buckets(pool)
+	{
+		m_buckets.resize(GROUP_MIN_BUCKETS, END_OF_CHAIN);
+	}
+
+	~HashTable()
+	{
+		for (UCHAR** block = m_blocks.begin(); block < m_blocks.end(); block++)
+			delete[] *block;
+	}
+
+	static ULONG getEntrySize(ULONG keyLength, ULONG dataLength, ULONG stateLength)
+	{
+		return getDataOffset(keyLength) + FB_ALIGN(dataLength, FB_ALIGNMENT) + stateLength;
+	}
+
+	// Find the group by its key
+	UCHAR* find(ULONG hash, const UCHAR* key) const
+	{
+		for (ULONG index = m_buckets[hash & (m_buckets.getCount() - 1)]; index != END_OF_CHAIN;)
+		{
+			UCHAR* const group = m_groups[index];
+			const Entry* const entry = reinterpret_cast<const Entry*>(group);
+
+			if (entry->hash == hash && !memcmp(group + sizeof(Entry), key, m_keyLength))
+				return group;
+
+			index = entry->next;
+		}
+
+		return NULL;
+	}
+
+	// Add the new group.
+	// Returns NULL if it doesn't fit the memory limit.
+	UCHAR* add(ULONG hash, const UCHAR* key)
+	{
+		UCHAR* const group = allocate();
+		if (!group)
+			return NULL;
+
+		ULONG* const bucket = &m_buckets[hash & (m_buckets.getCount() - 1)];
+
+		Entry* const entry = reinterpret_cast<Entry*>(group);
+		entry->hash = hash;
+		entry->next = *bucket;
+		memcpy(group + sizeof(Entry), key, m_keyLength);
+
+		*bucket = m_groups.getCount();
+		m_groups.add(group);
+
+		if (m_groups.getCount() > m_buckets.getCount() * GROUP_LOAD_FACTOR)
+			grow();
+
+		return group;
+	}
+
+	ULONG getCount() const
+	{
+		return m_groups.getCount();
+	}
+
+	UCHAR* getGroup(ULONG index) const
+	{
+		return m_groups[index];
+	}
+
+	UCHAR* getData(UCHAR* group) const
+	{
+		return group + m_dataOffset;
+	}
+
+	UCHAR* getState(UCHAR* group) const
+	{
+		return group + m_stateOffset;
+	}
+
+private:
+	static ULONG getDataOffset(ULONG keyLength)
+	{
+		return FB_ALIGN(sizeof(Entry) + keyLength, FB_ALIGNMENT);
+	}
+
+	UCHAR* allocate()
+	{
+		if (m_blockFree < m_entryLength)
+		{
+			const ULONG blockSize = MAX(GROUP_BLOCK_SIZE, m_entryLength);
+
+			if (m_memoryUsed + blockSize > m_memoryLimit)
+				return NULL;
+
+			m_blocks.add(FB_NEW_POOL(getPool()) UCHAR[blockSize]);
+			m_memoryUsed += blockSize;
+			m_blockFree = blockSize;
+		}
+
+		UCHAR* const group = m_blocks.back() + (MAX(GROUP_BLOCK_SIZE, m_entryLength) - m_blockFree);
+		m_blockFree -= m_entryLength;
+		return group;
+	}
+
+	void grow()
+	{
+		const ULONG count = m_buckets.getCount() * 2;
+
+		m_memoryUsed += (count - m_buckets.getCount()) * sizeof(ULONG);
+
+		m_buckets.clear();
+		m_buckets.resize(count, END_OF_CHAIN);
+
+		for (ULONG index = 0; index < m_groups.getCount(); index++)
+		{
+			Entry* const entry = reinterpret_cast<Entry*>(m_groups[index]);
+			ULONG* const bucket = &m_buckets[entry->hash & (count - 1)];
+
+			entry->next = *bucket;
+			*bucket = index;
+		}
+	}
+
+	const ULONG m_keyLength;
+	const ULONG m_dataOffset;
+	const ULONG m_stateOffset;
+	const ULONG m_entryLength;
+	const FB_UINT64 m_memoryLimit;
+	FB_UINT64 m_memoryUsed;
+	Array<UCHAR*> m_blocks;
+	ULONG m_blockFree;
+	Array<UCHAR*> m_groups;
+	Array<ULONG> m_buckets;
+};
+
 // ------------------------------
 
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
-			const NestValueArray* group, MapNode* map, RecordSource* next)
-	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
+			NestValueArray* group, MapNode* map, RecordSource* next, bool groupOrdered)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next),
+	  m_keyDescs(csb->csb_pool),
+	  m_keyLengths(csb->csb_pool),
+	  m_keyLength(0),
+	  m_stateLength(0),
+	  m_memoryLimit(0)
 {
 	fb_assert(map);
+
+	// If the input must be sorted to find the groups, consider building
+	// the groups in a hash table instead. The sort is still kept for the input
+	// records of the groups that don't fit the memory limit. The hashed groups
+	// are returned unordered, so this is not possible if the optimizer relies
+	// on the group sort to deliver the ORDER BY or DISTINCT order.
+
+	const auto sortedStream = (group && !groupOrdered) ? dynamic_cast<SortedStream*>(next) : nullptr;
+	const FB_UINT64 memoryLimit = tdbb->getDatabase()->dbb_config->getHashAggregateMemoryLimit();
+
+	if (sortedStream && memoryLimit && canHash(tdbb, csb, group, map))
+	{
+		const ULONG entrySize = HashTable::getEntrySize(m_keyLength, m_format->fmt_length, m_stateLength);
+
+		if (m_cardinality * entrySize <= memoryLimit)
+		{
+			m_hashNext = sortedStream->getInput();
+			m_sortedNext = sortedStream;
+			m_memoryLimit = memoryLimit;
+		}
+	}
+}
+
+void AggregatedStream::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		if (impure->hashTable)
+		{
+			delete impure->hashTable;
+			impure->hashTable = nullptr;
+
+			m_hashNext->close(tdbb);
+		}
+	}
+
+	BaseAggWinStream::close(tdbb);
 }
 
 void AggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
-	m_next->getLegacyPlan(tdbb, plan, level);
+	if (m_hashNext)
+		m_hashNext->getLegacyPlan(tdbb, plan, level);
+	else
+		m_next->getLegacyPlan(tdbb, plan, level);
 }
 
 void AggregatedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
 {
 	planEntry.className = "AggregatedStream";
 
-	planEntry.lines.add().text = "Aggregate";
+	planEntry.lines.add().text = m_hashNext ? "Hash Aggregate" : "Aggregate";
 	printOptInfo(planEntry.lines);
 
 	if (recurse)
 	{
 		++level;
-		m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
+
+		// The sort of the groups not fitting the hash table is used
+		// as a spill area only, the input is read unsorted
+
+		if (m_hashNext)
+			m_hashNext->getPlan(tdbb, planEntry.children.add(), level, recurse);
+		else
+			m_next->getPlan(tdbb, planEntry.children.add(), level, recurse);
 	}
 }
 
+void AggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	delete impure->hashTable;
+	impure->hashTable = nullptr;
+
+	if (!m_hashNext)
+	{
+		BaseAggWinStream::internalOpen(tdbb);
+		return;
+	}
+
+	initImpure(tdbb);
+
+	MemoryPool& pool = *request->req_pool;
+
+	impure->hashTable = FB_NEW_POOL(pool)
+		HashTable(pool, m_keyLength, m_format->fmt_length, m_stateLength, m_memoryLimit);
+	impure->hashPosition = 0;
+	impure->hashSpilled = false;
+
+	m_hashNext->open(tdbb);
+}
+
 bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 {
 	JRD_reschedule(tdbb);
 
 	Request* const request = tdbb->getRequest();
 	record_param* const rpb = &request->req_rpb[m_stream];
-	Impure* const impure = getImpure(request);
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	if (!(impure->irsb_flags & irsb_open))
 	{
@@ -408,6 +667,45 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (HashTable* const hashTable = impure->hashTable)
+	{
+		if (impure->state == STATE_GROUPING)
+		{
+			impure->hashSpilled = !buildHashTable(tdbb, request, hashTable);
+
+			// The input of the spilled groups is closed together with their sort
+			if (!impure->hashSpilled)
+				m_hashNext->close(tdbb);
+
+			impure->state = STATE_EOF;
+		}
+
+		if (impure->hashPosition < hashTable->getCount())
+		{
+			UCHAR* const group = hashTable->getGroup(impure->hashPosition++);
+
+			rpb->rpb_record->copyDataFrom(hashTable->getData(group));
+			restoreState(request, hashTable->getState(group));
+			aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+
+		if (!impure->hashSpilled)
+		{
+			rpb->rpb_number.setValid(false);
+			return false;
+		}
+
+		// All the hashed groups are returned, continue with the sorted ones
+
+		delete impure->hashTable;
+		impure->hashTable = nullptr;
+
+		impure->state = STATE_GROUPING;
+	}
+
 	if (!evaluateGroup(tdbb))
 	{
 		rpb->rpb_number.setValid(false);
@@ -417,3 +715,238 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+// Check whether the groups may be built using the hash table
+// and compute the lengths of the group keys and the aggregate states.
+bool AggregatedStream::canHash(thread_db* tdbb, CompilerScratch* csb,
+	NestValueArray* group, MapNode* map)
+{
+	for (auto& node : *group)
+	{
+		dsc desc;
+		node->getDesc(tdbb, csb, &desc);
+
+		if (desc.isBlob() || desc.dsc_dtype == dtype_array)
+			return false;
+
+		ULONG keyLength = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+		if (IS_INTL_DATA(&desc))
+			keyLength = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), keyLength);
+		else if (desc.isTime())
+			keyLength = sizeof(ISC_TIME);
+		else if (desc.isTimeStamp())
+			keyLength = sizeof(ISC_TIMESTAMP);
+		else if (desc.dsc_dtype == dtype_dec64)
+			keyLength = Decimal64::getKeyLength();
+		else if (desc.dsc_dtype == dtype_dec128)
+			keyLength = Decimal128::getKeyLength();
+
+		desc.dsc_address = NULL;
+		m_keyDescs.add(desc);
+		m_keyLengths.add(keyLength);
+		m_keyLength += 1 + keyLength;	// null flag and value
+	}
+
+	for (auto& source : map->sourceList)
+	{
+		const auto aggNode = nodeAs<AggNode>(source);
+
+		if (!aggNode)
+			continue;
+
+		if (!(aggNode->getCapabilities() & AggNode::CAP_COPYABLE_STATE) ||
+			aggNode->distinct || aggNode->indexed)
+		{
+			return false;
+		}
+
+		// MIN/MAX of strings keep their values outside the impure area
+
+		if (aggNode->arg &&
+			(aggNode->aggInfo.blr == blr_agg_min || aggNode->aggInfo.blr == blr_agg_max))
+		{
+			dsc desc;
+			aggNode->arg->getDesc(tdbb, csb, &desc);
+
+			if (desc.isText() || desc.isBlob())
+				return false;
+		}
+
+		m_stateLength += sizeof(impure_value_ex);
+	}
+
+	return true;
+}
+
+// Read the whole input and aggregate it into the hash table. Once the memory
+// limit is reached, the input records of the groups that are not in the table yet
+// are put into the sort instead, to be aggregated after the hashed groups.
+// Returns false if some records are put into the sort.
+bool AggregatedStream::buildHashTable(thread_db* tdbb, Request* request, HashTable* hashTable) const
+{
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+
+	HalfStaticArray<UCHAR, 256> keyBuffer;
+	UCHAR* const key = keyBuffer.getBuffer(m_keyLength);
+
+	bool spilled = false;
+
+	while (m_hashNext->getRecord(tdbb))
+	{
+		const ULONG hash = computeKey(tdbb, request, key);
+
+		UCHAR* group = hashTable->find(hash, key);
+		const bool found = (group != NULL);
+
+		// No new groups are added after the first spill, so every group
+		// is either completely hashed or completely sorted
+		if (!found && !spilled)
+			group = hashTable->add(hash, key);
+
+		if (!group)
+		{
+			if (!spilled)
+			{
+				m_sortedNext->openSpill(tdbb);
+				spilled = true;
+			}
+
+			m_sortedNext->putSpill(tdbb);
+			continue;
+		}
+
+		if (found)
+			restoreState(request, hashTable->getState(group));
+		else
+			aggInit(tdbb, request, m_groupMap);
+
+		aggPass(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+		// Non-aggregated values are the same for the whole group, remember them once
+		if (!found)
+			record->copyDataTo(hashTable->getData(group));
+
+		saveState(request, hashTable->getState(group));
+	}
+
+	if (spilled)
+		m_sortedNext->sortSpill(tdbb);
+
+	return !spilled;
+}
+
+ULONG AggregatedStream::computeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const
+{
+	memset(keyBuffer, 0, m_keyLength);
+
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		const dsc* desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const dsc& keyDesc = m_keyDescs[i];
+		const ULONG keyLength = m_keyLengths[i];
+
+		if (desc && !(request->req_flags & req_null))
+		{
+			*keyPtr = 1;
+			UCHAR* const valuePtr = keyPtr + 1;
+
+			if (keyDesc.isText())
+			{
+				dsc to;
+				to.makeText(keyLength, keyDesc.getTextType(), valuePtr);
+
+				if (IS_INTL_DATA(&keyDesc))
+				{
+					// Convert the INTL string into the binary comparable form
+					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&keyDesc),
+									   desc, &to, INTL_KEY_UNIQUE);
+				}
+				else
+				{
+					// This call ensures that the padding bytes are appended
+					MOV_move(tdbb, const_cast<dsc*>(desc), &to);
+				}
+			}
+			else
+			{
+				// The value may come with another type than the one declared
+				// for the expression (e.g. from COALESCE or CASE), so convert it
+				// the same way the sort does to get the same groups
+				impure_value temp;
+
+				if (!DSC_EQUIV(desc, &keyDesc, false))
+				{
+					dsc* const to = &temp.vlu_desc;
+					*to = keyDesc;
+					to->dsc_address = (UCHAR*) &temp.vlu_misc;
+					MOV_move(tdbb, const_cast<dsc*>(desc), to);
+					desc = to;
+				}
+
+				const auto data = desc->dsc_address;
+
+				if (desc->isDecFloat())
+				{
+					OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(valuePtr, keyLength);
+
+					if (desc->dsc_dtype == dtype_dec64)
+						((Decimal64*) data)->makeKey(key);
+					else if (desc->dsc_dtype == dtype_dec128)
+						((Decimal128*) data)->makeKey(key);
+					else
+						fb_assert(false);
+				}
+				else if ((desc->dsc_dtype == dtype_real && *(float*) data == 0) ||
+					(desc->dsc_dtype == dtype_double && *(double*) data == 0))
+				{
+					// positive zero in binary, already zeroed
+				}
+				else
+				{
+					// Note: for date/time with time zone, we copy only the UTC part
+					fb_assert(keyLength <= desc->dsc_length);
+					memcpy(valuePtr, data, keyLength);
+				}
+			}
+		}
+
+		keyPtr += 1 + keyLength;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_keyLength);
+
+	return InternalHash::hash(m_keyLength, keyBuffer);
+}
+
+// Save the states of the aggregate functions for the current group
+void AggregatedStream::saveState(Request* request, UCHAR* state) const
+{
+	for (const auto& source : m_groupMap->sourceList)
+	{
+		if (const auto aggNode = nodeAs<AggNode>(source))
+		{
+			memcpy(state, request->getImpure<impure_value_ex>(aggNode->impureOffset),
+				sizeof(impure_value_ex));
+			state += sizeof(impure_value_ex);
+		}
+	}
+}
+
+// Restore the states of the aggregate functions for the current group.
+// The states are restored at the same addresses, so descriptors pointing
+// inside the impure area remain valid.
+void AggregatedStream::restoreState(Request* request, const UCHAR* state) const
+{
+	for (const auto& source : m_groupMap->sourceList)
+	{
+		if (const auto aggNode = nodeAs<AggNode>(source))
+		{
+			memcpy(request->getImpure<impure_value_ex>(aggNode->impureOffset), state,
+				sizeof(impure_value_ex));
+			state += sizeof(impure_value_ex);
+		}
+	}
+}
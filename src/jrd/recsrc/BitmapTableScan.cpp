@@ -22,6 +22,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/req.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
@@ -59,6 +60,8 @@ void BitmapTableScan::internalOpen(thread_db* tdbb) const
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
 
 	rpb->rpb_number.setValue(BOF_NUMBER);
+	rpb->rpb_prefetch_seq = 0;
+	rpb->rpb_prefetch_depth = 0;
 }
 
 void BitmapTableScan::close(thread_db* tdbb) const
@@ -110,6 +113,8 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 		{
 			rpb->rpb_number.setValue(bitmap->current());
 
+			DPM_read_ahead_bitmap(tdbb, rpb, bitmap);
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				rpb->rpb_number.setValid(true);
@@ -175,52 +175,8 @@ bool BufferedStream::internalGetRecord(thread_db* tdbb) const
 			return false;
 		}
 
-		buffer_record->nullify();
-
-		// Assign the fields to the record to be stored
-		for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
-		{
-			const FieldMap& map = m_map[i];
-
-			record_param* const rpb = &request->req_rpb[map.map_stream];
-			Record* const record = rpb->rpb_record;
-
-			if (map.map_type == FieldMap::REGULAR_FIELD)
-			{
-				if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
-					continue;
-			}
-
-			buffer_record->clearNull(i);
-
-			if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
-				fb_assert(false);
-
-			switch (map.map_type)
-			{
-			case FieldMap::REGULAR_FIELD:
-				MOV_move(tdbb, &from, &to);
-				break;
-
-			case FieldMap::TRANSACTION_ID:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-				break;
-
-			case FieldMap::DBKEY_NUMBER:
-				*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-				break;
-
-			case FieldMap::DBKEY_VALID:
-				*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-				break;
-
-			default:
-				fb_assert(false);
-			}
-		}
-
 		// Put the record into the buffer
-		impure->irsb_buffer->store(buffer_record);
+		storeRecord(tdbb, request, impure->irsb_buffer);
 	}
 	else
 	{
@@ -304,6 +260,84 @@ bool BufferedStream::internalGetRecord(thread_db* tdbb) const
 	return true;
 }
 
+// Store the current records of the underlying streams into the buffer
+FB_UINT64 BufferedStream::storeRecord(thread_db* tdbb, Request* request, RecordBuffer* buffer) const
+{
+	dsc from, to;
+
+	Record* const buffer_record = buffer->getTempRecord();
+
+	buffer_record->nullify();
+
+	// Assign the fields to the record to be stored
+	for (FB_SIZE_T i = 0; i < m_map.getCount(); i++)
+	{
+		const FieldMap& map = m_map[i];
+
+		record_param* const rpb = &request->req_rpb[map.map_stream];
+		Record* const record = rpb->rpb_record;
+
+		if (map.map_type == FieldMap::REGULAR_FIELD)
+		{
+			if (!EVL_field(rpb->rpb_relation, record, map.map_id, &from))
+				continue;
+		}
+
+		buffer_record->clearNull(i);
+
+		if (!EVL_field(rpb->rpb_relation, buffer_record, (USHORT) i, &to))
+			fb_assert(false);
+
+		switch (map.map_type)
+		{
+		case FieldMap::REGULAR_FIELD:
+			MOV_move(tdbb, &from, &to);
+			break;
+
+		case FieldMap::TRANSACTION_ID:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+			break;
+
+		case FieldMap::DBKEY_NUMBER:
+			*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+			break;
+
+		case FieldMap::DBKEY_VALID:
+			*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+			break;
+
+		default:
+			fb_assert(false);
+		}
+	}
+
+	return buffer->store(buffer_record);
+}
+
+void BufferedStream::openSpill(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	impure->irsb_flags = irsb_open;
+
+	delete impure->irsb_buffer;
+	MemoryPool& pool = *tdbb->getDefaultPool();
+	impure->irsb_buffer = FB_NEW_POOL(pool) RecordBuffer(pool, m_format);
+
+	impure->irsb_position = 0;
+}
+
+FB_UINT64 BufferedStream::putSpill(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	fb_assert((impure->irsb_flags & irsb_open) && !(impure->irsb_flags & irsb_mustread));
+
+	return storeRecord(tdbb, request, impure->irsb_buffer);
+}
+
 bool BufferedStream::refetchRecord(thread_db* tdbb) const
 {
 	return m_next->refetchRecord(tdbb);
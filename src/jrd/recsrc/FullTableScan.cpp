@@ -25,13 +25,512 @@
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
+#include "../jrd/met_proto.h"
+#include "../jrd/tra_proto.h"
 #include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
+#include "../common/StatusHolder.h"
+#include "../common/classes/ClumpletWriter.h"
 
 #include "RecordSource.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	const ULONG SCAN_CHUNK_PAGES = 64;		// data pages scanned by a worker at once
+	const ULONG SCAN_ROUND_CHUNKS = 4;		// chunks per worker fetched by a single round
+	const ULONG SCAN_MIN_CHUNKS = 4;		// smaller tables are not worth scanning in parallel
+
+	// Header of the record copied by the worker into the chunk buffer
+	struct ScanRecord
+	{
+		SINT64 number;
+		TraNumber transaction;
+		ULONG length;
+		USHORT format;
+	};
+}
+
+// -------------------------------------------
+// Data access: parallel sequential table scan
+// -------------------------------------------
+
+// Worker attachments read the data pages of the relation using their own
+// transactions sharing the snapshot of the reader. The relation is split
+// into chunks of SCAN_CHUNK_PAGES data pages, a round of chunks is scanned
+// in parallel and copied records are then returned by the reader in the
+// natural order, so the stream behaves exactly like a sequential scan.
+// While the reader processes records of one round (evaluates booleans,
+// aggregates, etc), workers already scan the next one into the second
+// half of the chunk buffers.
+
+class FullTableScan::ParallelScan : public Task
+{
+public:
+	ParallelScan(thread_db* tdbb, MemoryPool& pool, const jrd_tra* transaction, jrd_rel* relation,
+				 int workers, bool noData, bool largeScan);
+	virtual ~ParallelScan();
+
+	static bool isSuitable(thread_db* tdbb, const jrd_tra* transaction, jrd_rel* relation);
+
+	bool getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool);
+	void stop(thread_db* tdbb);
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+	bool getResult(IStatus* status);
+	int getMaxWorkers();
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(ParallelScan* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_tra(NULL),
+			m_chunk(0)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		bool init(thread_db* tdbb);
+
+		ParallelScan* getTask() const
+		{
+			return reinterpret_cast<ParallelScan*> (m_task);
+		}
+
+		bool m_inuse;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		ULONG m_chunk;
+	};
+
+	bool fetch(thread_db* tdbb);
+	void startRound(thread_db* tdbb);
+
+	void setError(IStatus* status, bool stopTask)
+	{
+		const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+		if (!copyStatus && (!stopTask || m_stop))
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && copyStatus)
+			m_status.save(status);
+		if (stopTask)
+			m_stop = true;
+	}
+
+	Database* const m_dbb;
+	const USHORT m_relationId;
+	const CommitNumber m_snapshot;
+	const bool m_noData;
+	const bool m_largeScan;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	volatile bool m_stop;
+
+	ULONG m_chunksPerPP;
+	ULONG m_countChunks;
+	ULONG m_nextChunk;
+	ULONG m_roundSize;
+
+	// Round being scanned by workers
+	bool m_scanning;
+	ULONG m_scanStart;
+	ULONG m_scanEnd;
+	ULONG m_scanBuffer;
+
+	// Round being read by the reader
+	ObjectsArray<Array<UCHAR> > m_chunks;
+	ULONG m_readChunk;
+	ULONG m_readEnd;
+	FB_SIZE_T m_readOffset;
+
+	Coordinator m_coord;
+};
+
+FullTableScan::ParallelScan::ParallelScan(thread_db* tdbb, MemoryPool& pool, const jrd_tra* transaction,
+										  jrd_rel* relation, int workers, bool noData, bool largeScan)
+	: Task(),
+	  m_dbb(tdbb->getDatabase()),
+	  m_relationId(relation->rel_id),
+	  m_snapshot(transaction->tra_snapshot_number),
+	  m_noData(noData),
+	  m_largeScan(largeScan),
+	  m_items(pool),
+	  m_stop(false),
+	  m_nextChunk(0),
+	  m_roundSize(workers * SCAN_ROUND_CHUNKS),
+	  m_scanning(false),
+	  m_scanStart(0),
+	  m_scanEnd(0),
+	  m_scanBuffer(0),
+	  m_chunks(pool),
+	  m_readChunk(0),
+	  m_readEnd(0),
+	  m_readOffset(0),
+	  m_coord(&pool)
+{
+	m_chunksPerPP = (m_dbb->dbb_dp_per_pp + SCAN_CHUNK_PAGES - 1) / SCAN_CHUNK_PAGES;
+	m_countChunks = DPM_pointer_pages(tdbb, relation) * m_chunksPerPP;
+
+	for (int i = 0; i < workers; i++)
+		m_items.add(FB_NEW_POOL(pool) Item(this));
+
+	for (ULONG i = 0; i < m_roundSize * 2; i++)
+		m_chunks.add();
+}
+
+FullTableScan::ParallelScan::~ParallelScan()
+{
+	fb_assert(!m_scanning);
+
+	if (m_scanning)
+		m_coord.waitAsync();
+
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		delete *p;
+}
+
+bool FullTableScan::ParallelScan::isSuitable(thread_db* tdbb, const jrd_tra* transaction, jrd_rel* relation)
+{
+	const Database* const dbb = tdbb->getDatabase();
+	const Attachment* const attachment = tdbb->getAttachment();
+
+	if (!attachment || attachment->att_parallel_workers <= 1 || attachment->isGbak())
+		return false;
+
+	// Classic in single-user shutdown mode can't create additional worker attachments
+	if ((dbb->dbb_ast_flags & DBB_shutdown_single) && !(dbb->dbb_flags & DBB_shared))
+		return false;
+
+	// Worker transactions can share the snapshot of a concurrency transaction only.
+	// Also they can't see changes made by the reader, so it must be read-only.
+
+	if (!(transaction->tra_flags & TRA_readonly) ||
+		(transaction->tra_flags & (TRA_read_committed | TRA_degree3 | TRA_system)) ||
+		!transaction->tra_snapshot_number)
+	{
+		return false;
+	}
+
+	if (relation->isTemporary() || relation->isVirtual() || relation->rel_file)
+		return false;
+
+	return DPM_data_pages(tdbb, relation) >= SCAN_CHUNK_PAGES * SCAN_MIN_CHUNKS;
+}
+
+void FullTableScan::ParallelScan::startRound(thread_db* tdbb)
+{
+	fb_assert(!m_scanning && m_nextChunk < m_countChunks);
+
+	m_scanStart = m_nextChunk;
+	m_scanEnd = MIN(m_scanStart + m_roundSize, m_countChunks);
+	m_scanBuffer = m_scanBuffer ? 0 : m_roundSize;
+	m_scanning = true;
+
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+	m_coord.runAsync(this);
+}
+
+bool FullTableScan::ParallelScan::fetch(thread_db* tdbb)
+{
+	if (!m_scanning)
+	{
+		if (m_nextChunk >= m_countChunks)
+			return false;
+
+		startRound(tdbb);
+	}
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		m_coord.waitAsync();
+	}
+
+	m_scanning = false;
+
+	FbLocalStatus status;
+	if (!getResult(&status))
+		status.raise();
+
+	m_readChunk = m_scanBuffer;
+	m_readEnd = m_scanBuffer + m_scanEnd - m_scanStart;
+	m_readOffset = 0;
+
+	// Read ahead the next round while the reader is busy with this one
+
+	if (m_nextChunk < m_countChunks)
+		startRound(tdbb);
+
+	return true;
+}
+
+void FullTableScan::ParallelScan::stop(thread_db* tdbb)
+{
+	if (m_scanning)
+	{
+		m_stop = true;
+
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+		m_coord.waitAsync();
+		m_scanning = false;
+	}
+}
+
+bool FullTableScan::ParallelScan::getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
+{
+	do
+	{
+		while (m_readChunk < m_readEnd)
+		{
+			const Array<UCHAR>& buffer = m_chunks[m_readChunk];
+
+			if (m_readOffset < buffer.getCount())
+			{
+				const UCHAR* const ptr = buffer.begin() + m_readOffset;
+				const ScanRecord* const header = reinterpret_cast<const ScanRecord*>(ptr);
+				m_readOffset += FB_ALIGN(sizeof(ScanRecord) + header->length, FB_ALIGNMENT);
+
+				rpb->rpb_number.setValue(header->number);
+				rpb->rpb_transaction_nr = header->transaction;
+
+				if (header->length)
+				{
+					rpb->rpb_format_number = header->format;
+					Record* const record = VIO_record(tdbb, rpb, NULL, pool);
+					fb_assert(record->getLength() == header->length);
+					record->copyDataFrom(ptr + sizeof(ScanRecord));
+				}
+
+				// Workers account reads in their own attachments, count it for the reader too
+				tdbb->bumpRelStats(RuntimeStatistics::RECORD_SEQ_READS, m_relationId);
+				return true;
+			}
+
+			m_readChunk++;
+			m_readOffset = 0;
+		}
+	} while (fetch(tdbb));
+
+	return false;
+}
+
+bool FullTableScan::ParallelScan::Item::init(thread_db* tdbb)
+{
+	FbStatusVector* status = tdbb->tdbb_status_vector;
+	Attachment* att = NULL;
+
+	if (!m_attStable.hasData())
+		m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+	if (m_attStable)
+		att = m_attStable->getHandle();
+
+	if (!att)
+	{
+		if (!status->hasData())
+			Arg::Gds(isc_bad_db_handle).copyTo(status);
+
+		return false;
+	}
+
+	tdbb->setDatabase(att->att_database);
+	tdbb->setAttachment(att);
+
+	if (!m_tra)
+	{
+		try
+		{
+			WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+			ClumpletWriter tpb(ClumpletReader::Tpb, 128, isc_tpb_version3);
+			tpb.insertTag(isc_tpb_concurrency);
+			tpb.insertTag(isc_tpb_read);
+			tpb.insertBigInt(isc_tpb_at_snapshot_number, getTask()->m_snapshot);
+
+			m_tra = TRA_start(tdbb, tpb.getBufferLength(), tpb.getBuffer());
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+			return false;
+		}
+	}
+
+	tdbb->setTransaction(m_tra);
+	return true;
+}
+
+bool FullTableScan::ParallelScan::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	if (!item->init(tdbb))
+	{
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	record_param rpb;
+	jrd_rel* relation = NULL;
+
+	try
+	{
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		relation = MET_relation(tdbb, m_relationId);
+		if (!(relation->rel_flags & REL_scanned))
+			MET_scan_relation(tdbb, relation);
+
+		Array<UCHAR>& buffer = m_chunks[m_scanBuffer + item->m_chunk - m_scanStart];
+		buffer.clear();
+
+		rpb.rpb_relation = relation;
+
+		if (m_noData)
+			rpb.rpb_stream_flags |= RPB_s_no_data;
+
+		if (m_largeScan)
+		{
+			rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb.rpb_org_scans = relation->rel_scan_count++;
+		}
+
+		const ULONG sequence = item->m_chunk / m_chunksPerPP;
+		const USHORT slot = (item->m_chunk % m_chunksPerPP) * SCAN_CHUNK_PAGES;
+
+		rpb.rpb_number.compose(m_dbb->dbb_max_records, m_dbb->dbb_dp_per_pp, 0, slot, sequence);
+		rpb.rpb_number.decrement();
+
+		RecordNumber upper;
+		upper.compose(m_dbb->dbb_max_records, m_dbb->dbb_dp_per_pp, 0, slot + SCAN_CHUNK_PAGES, sequence);
+		upper.decrement();
+
+		MemoryPool* const pool = item->m_tra->tra_pool;
+
+		while (!m_stop &&
+			VIO_next_record(tdbb, &rpb, item->m_tra, pool, DPM_next_pointer_page, &upper))
+		{
+			const Record* const record = m_noData ? NULL : rpb.rpb_record;
+			const ULONG length = record ? record->getLength() : 0;
+
+			const FB_SIZE_T offset = buffer.getCount();
+			UCHAR* const ptr =
+				buffer.getBuffer(offset + FB_ALIGN(sizeof(ScanRecord) + length, FB_ALIGNMENT)) + offset;
+
+			ScanRecord* const header = reinterpret_cast<ScanRecord*>(ptr);
+			header->number = rpb.rpb_number.getValue();
+			header->transaction = rpb.rpb_transaction_nr;
+			header->length = length;
+			header->format = record ? record->getFormat()->fmt_version : 0;
+
+			if (length)
+				record->copyDataTo(ptr + sizeof(ScanRecord));
+
+			JRD_reschedule(tdbb);
+		}
+
+		if (m_largeScan)
+			--relation->rel_scan_count;
+	}
+	catch (const Exception& ex)
+	{
+		if ((rpb.getWindow(tdbb).win_flags & WIN_large_scan) &&
+			relation && relation->rel_scan_count)
+		{
+			relation->rel_scan_count--;
+		}
+
+		delete rpb.rpb_record;
+
+		ex.stuffException(tdbb->tdbb_status_vector);
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	delete rpb.rpb_record;
+	return true;
+}
+
+bool FullTableScan::ParallelScan::getWorkItem(WorkItem** pItem)
+{
+	Item* item = reinterpret_cast<Item*> (*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop)
+		return false;
+
+	if (item == NULL)
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			if (!(*p)->m_inuse)
+			{
+				(*p)->m_inuse = true;
+				*pItem = item = *p;
+				break;
+			}
+	}
+
+	if (!item)
+		return false;
+
+	item->m_inuse = (m_nextChunk < m_scanEnd);
+
+	if (item->m_inuse)
+		item->m_chunk = m_nextChunk++;
+
+	return item->m_inuse;
+}
+
+bool FullTableScan::ParallelScan::getResult(IStatus* status)
+{
+	if (status)
+	{
+		status->init();
+		status->setErrors(m_status.getErrors());
+	}
+
+	return m_status.isSuccess();
+}
+
+int FullTableScan::ParallelScan::getMaxWorkers()
+{
+	return MIN(m_items.getCount(), m_scanEnd - m_scanStart);
+}
+
 // -------------------------------------------
 // Data access: sequential complete table scan
 // -------------------------------------------
@@ -57,6 +556,13 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 
+	if (impure->irsb_parallel)
+	{
+		impure->irsb_parallel->stop(tdbb);
+		delete impure->irsb_parallel;
+		impure->irsb_parallel = nullptr;
+	}
+
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation, false);
 
 	record_param* const rpb = &request->req_rpb[m_stream];
@@ -88,6 +594,18 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	rpb->rpb_number.setValue(BOF_NUMBER);
 
+	// Scan big tables using parallel workers, if allowed
+
+	if (m_dbkeyRanges.isEmpty() && !(rpb->rpb_stream_flags & RPB_s_update) &&
+		ParallelScan::isSuitable(tdbb, request->req_transaction, m_relation))
+	{
+		impure->irsb_parallel = FB_NEW_POOL(*request->req_pool)
+			ParallelScan(tdbb, *request->req_pool, request->req_transaction, m_relation,
+						 attachment->att_parallel_workers,
+						 (rpb->rpb_stream_flags & RPB_s_no_data),
+						 (rpb->getWindow(tdbb).win_flags & WIN_large_scan));
+	}
+
 	if (m_dbkeyRanges.hasData())
 	{
 		impure->irsb_lower.setValid(false);
@@ -123,6 +641,13 @@ void FullTableScan::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
+		if (impure->irsb_parallel)
+		{
+			impure->irsb_parallel->stop(tdbb);
+			delete impure->irsb_parallel;
+			impure->irsb_parallel = nullptr;
+		}
+
 		record_param* const rpb = &request->req_rpb[m_stream];
 		if ((rpb->getWindow(tdbb).win_flags & WIN_large_scan) &&
 			m_relation->rel_scan_count)
@@ -146,6 +671,18 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (impure->irsb_parallel)
+	{
+		if (impure->irsb_parallel->getRecord(tdbb, rpb, request->req_pool))
+		{
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
 	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
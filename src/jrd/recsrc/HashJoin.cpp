@@ -41,144 +41,398 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static const ULONG HASH_SIZE = 1009;
-static const ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per slot
+static const char* const SCRATCH = "fb_hash_";
+
+// The bucket directory is sized after the inner stream is read, so that every bucket
+// holds HASH_LOAD_FACTOR collisions on average regardless of the stream cardinality
+static const ULONG HASH_LOAD_FACTOR = 2;
+static const ULONG HASH_MIN_BITS = 4;
+static const ULONG HASH_MAX_BITS = 30;
+// Upper limit for the collisions preallocated from the optimizer estimation
+static const ULONG HASH_PREALLOCATE_LIMIT = 1024 * 1024;
+// Number of partitions the spilled entries are split into. The hashed streams are
+// processed in up to that many passes, every pass joining a group of partitions.
+static const ULONG HASH_MAX_PARTITIONS = 256;
+// Number of entries being written to the temporary space at once, per partition
+static const ULONG SPILL_CHUNK_SIZE = 128;
 
 unsigned HashJoin::maxCapacity()
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	// The lookup cost does not depend on the number of hashed rows anymore.
+	// The memory used is bounded by partitioning the hash table, but every
+	// partition costs another pass through the temporary space, so huge
+	// streams are still better joined some other way.
+	return 100 * 1000 * 1000;
 }
 
 
 class HashJoin::HashTable : public PermanentStorage
 {
-	class CollisionList
+	struct Entry
 	{
-		static const FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
+		Entry()
+			: hash(0), position(0)
+		{}
 
-		struct Entry
+		Entry(ULONG h, ULONG pos)
+			: hash(h), position(pos)
+		{}
+
+		ULONG hash;
+		ULONG position;
+	};
+
+	// Entries stored in the temporary space, split into partitions by the low bits
+	// of their hashes. Every partition is written in chunks linked together,
+	// so that it can be read back without reading the other partitions.
+
+	class SpillFile
+	{
+		struct Chunk
 		{
-			Entry()
-				: hash(0), position(0)
-			{}
+			FB_UINT64 offset;
+			ULONG count;
+			ULONG prior;
+		};
 
-			Entry(ULONG h, ULONG pos)
-				: hash(h), position(pos)
-			{}
+		static const ULONG END_OF_CHAIN = MAX_ULONG;
 
-			static const ULONG generate(const Entry& item)
+	public:
+		explicit SpillFile(MemoryPool& pool)
+			: m_space(pool, SCRATCH, false), m_chunks(pool), m_buffer(pool),
+			  m_length(0), m_count(0), m_chunk(END_OF_CHAIN), m_position(0), m_bufferCount(0),
+			  m_partition(0), m_partitionMask(0)
+		{
+			m_buffer.getBuffer(HASH_MAX_PARTITIONS * SPILL_CHUNK_SIZE);
+
+			for (ULONG i = 0; i < HASH_MAX_PARTITIONS; i++)
 			{
-				return item.hash;
+				m_lastChunks[i] = END_OF_CHAIN;
+				m_counts[i] = 0;
 			}
+		}
 
-			ULONG hash;
-			ULONG position;
-		};
+		FB_UINT64 getCount() const
+		{
+			return m_count;
+		}
 
-	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
+		void put(const Entry& entry)
+		{
+			const ULONG partition = entry.hash & (HASH_MAX_PARTITIONS - 1);
+
+			m_buffer[partition * SPILL_CHUNK_SIZE + m_counts[partition]++] = entry;
+			m_count++;
+
+			if (m_counts[partition] == SPILL_CHUNK_SIZE)
+				flush(partition);
+		}
+
+		void flush()
 		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
+			for (ULONG i = 0; i < HASH_MAX_PARTITIONS; i++)
+			{
+				if (m_counts[i])
+					flush(i);
+			}
 		}
 
-		void sort()
+		// Prepare for reading the partitions matching the given mask
+		void rewind(ULONG partitionMask, ULONG partition)
 		{
-			m_collisions.sort();
+			fb_assert(partitionMask < HASH_MAX_PARTITIONS);
+
+			m_partitionMask = partitionMask;
+			m_partition = partition & partitionMask;
+			m_chunk = m_lastChunks[m_partition];
+			m_position = 0;
+			m_bufferCount = 0;
+		}
+
+		bool get(Entry& entry)
+		{
+			while (m_position == m_bufferCount)
+			{
+				while (m_chunk == END_OF_CHAIN)
+				{
+					m_partition += m_partitionMask + 1;
+
+					if (m_partition >= HASH_MAX_PARTITIONS)
+						return false;
+
+					m_chunk = m_lastChunks[m_partition];
+				}
+
+				// Read the whole chunk into the buffer of the first partition,
+				// it's not needed for writing anymore
+
+				const Chunk& chunk = m_chunks[m_chunk];
+				m_space.read(chunk.offset, m_buffer.begin(), chunk.count * sizeof(Entry));
+				m_bufferCount = chunk.count;
+				m_position = 0;
+				m_chunk = chunk.prior;
+			}
+
+			entry = m_buffer[m_position++];
+			return true;
+		}
+
+	private:
+		void flush(ULONG partition)
+		{
+			Chunk chunk;
+			chunk.offset = m_length;
+			chunk.count = m_counts[partition];
+			chunk.prior = m_lastChunks[partition];
+
+			const FB_SIZE_T length = chunk.count * sizeof(Entry);
+			m_space.write(m_length, m_buffer.begin() + partition * SPILL_CHUNK_SIZE, length);
+			m_length += length;
+
+			m_lastChunks[partition] = m_chunks.getCount();
+			m_chunks.add(chunk);
+			m_counts[partition] = 0;
+		}
+
+		TempSpace m_space;
+		Array<Chunk> m_chunks;
+		Array<Entry> m_buffer;		// chunks being written, one per partition
+		FB_UINT64 m_length;			// bytes written to the temporary space
+		FB_UINT64 m_count;			// entries written
+		ULONG m_lastChunks[HASH_MAX_PARTITIONS];
+		ULONG m_counts[HASH_MAX_PARTITIONS];
+		// Reading state
+		ULONG m_chunk;
+		ULONG m_position;
+		ULONG m_bufferCount;
+		ULONG m_partition;
+		ULONG m_partitionMask;
+	};
+
+	class CollisionTable : public PermanentStorage
+	{
+	public:
+		CollisionTable(MemoryPool& pool, ULONG memoryLimit)
+			: PermanentStorage(pool), m_collisions(pool), m_entries(pool), m_buckets(pool),
+			  m_limit(memoryLimit / sizeof(Entry)),
+			  m_shift(32 - HASH_MIN_BITS), m_iterator(0), m_end(0)
+		{}
+
+		void reserve(ULONG count)
+		{
+			if (m_limit && count > m_limit)
+				count = m_limit;
+
+			m_collisions.ensureCapacity(count);
 		}
 
 		void add(ULONG hash, ULONG position)
 		{
+			if (m_spill)
+			{
+				m_spill->put(Entry(hash, position));
+				return;
+			}
+
 			m_collisions.add(Entry(hash, position));
+
+			if (m_limit && m_collisions.getCount() > m_limit)
+			{
+				// The limit is exceeded, move all the entries into the temporary space
+
+				m_spill = FB_NEW_POOL(getPool()) SpillFile(getPool());
+
+				for (const auto& collision : m_collisions)
+					m_spill->put(collision);
+
+				m_collisions.free();
+			}
+		}
+
+		bool isSpilled() const
+		{
+			return m_spill.hasData();
+		}
+
+		// Number of partitions needed for every partition to fit the memory limit
+		ULONG getPartitionCount() const
+		{
+			ULONG count = 1;
+
+			if (m_spill)
+			{
+				while (count < HASH_MAX_PARTITIONS && m_spill->getCount() / count > m_limit)
+					count <<= 1;
+			}
+
+			return count;
+		}
+
+		void build(ULONG partitionMask, ULONG partition)
+		{
+			if (m_spill)
+			{
+				// Load the collisions of the given partition from the temporary space.
+				// If many entries share the same hash value, the partition may still
+				// exceed the memory limit. It's loaded as a whole nevertheless,
+				// as such entries cannot be split between the partitions.
+
+				if (!partition)
+					m_spill->flush();
+
+				m_collisions.clear();
+				m_spill->rewind(partitionMask, partition);
+
+				Entry entry;
+				while (m_spill->get(entry))
+					m_collisions.add(entry);
+			}
+			else if (m_buckets.hasData())
+			{
+				// The table fits the memory limit, so it's built once
+				// and kept resident while all the partitions are processed
+				return;
+			}
+
+			const ULONG count = m_collisions.getCount();
+
+			ULONG bits = HASH_MIN_BITS;
+			while (bits < HASH_MAX_BITS && (1u << bits) < count / HASH_LOAD_FACTOR)
+				bits++;
+
+			const ULONG bucketCount = 1u << bits;
+			m_shift = 32 - bits;
+
+			// Distribute the collected entries between buckets (counting sort),
+			// so that every bucket occupies a contiguous range of the entries array.
+			// The original order (and thus the ascending order of positions)
+			// is preserved inside every bucket.
+
+			m_buckets.clear();
+			m_buckets.resize(bucketCount + 1, 0);
+
+			for (const auto& collision : m_collisions)
+				m_buckets[getBucket(collision.hash)]++;
+
+			for (ULONG i = 1; i < bucketCount; i++)
+				m_buckets[i] += m_buckets[i - 1];
+
+			fb_assert(m_buckets[bucketCount - 1] == count);
+			m_buckets[bucketCount] = count;
+
+			// Every bucket boundary now points to the end of the bucket.
+			// Fill the buckets backwards, so that they end up pointing to their starts.
+
+			Entry* const entries = m_entries.getBuffer(count, false);
+
+			for (ULONG i = count; i > 0; i--)
+			{
+				const Entry& collision = m_collisions[i - 1];
+				entries[--m_buckets[getBucket(collision.hash)]] = collision;
+			}
+
+			m_collisions.free();
+			m_iterator = m_end = 0;
 		}
 
 		bool locate(ULONG hash)
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
+			const ULONG bucket = getBucket(hash);
+
+			m_iterator = m_buckets[bucket];
+			m_end = m_buckets[bucket + 1];
+
+			for (; m_iterator < m_end; m_iterator++)
+			{
+				if (m_entries[m_iterator].hash == hash)
+					return true;
+			}
 
-			m_iterator = INVALID_ITERATOR;
 			return false;
 		}
 
 		bool iterate(ULONG hash, ULONG& position)
 		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
-
-			const Entry& collision = m_collisions[m_iterator++];
-
-			if (hash != collision.hash)
+			while (m_iterator < m_end)
 			{
-				m_iterator = INVALID_ITERATOR;
-				return false;
+				const Entry& entry = m_entries[m_iterator++];
+
+				if (entry.hash == hash)
+				{
+					position = entry.position;
+					return true;
+				}
 			}
 
-			position = collision.position;
-			return true;
+			return false;
 		}
 
 	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		ULONG getBucket(ULONG hash) const
+		{
+			// Multiplicative (Fibonacci) hashing, it uses the high bits of the product
+			// and thus does not depend on the low bits of the hash being well distributed.
+			// Partitions are selected using the low bits, so they don't affect buckets.
+			return (ULONG) (hash * 2654435769u) >> m_shift;
+		}
+
+		Array<Entry> m_collisions;	// entries collected while reading the stream
+		Array<Entry> m_entries;		// entries ordered by buckets
+		Array<ULONG> m_buckets;		// bucket boundaries inside m_entries
+		AutoPtr<SpillFile> m_spill;	// all entries, if they don't fit the memory limit
+		const ULONG m_limit;		// maximum number of entries kept in memory
+		ULONG m_shift;
+		ULONG m_iterator;
+		ULONG m_end;
 	};
 
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
+	HashTable(MemoryPool& pool, ULONG streamCount, FB_UINT64 memoryLimit)
 		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+		  m_memoryLimit(memoryLimit), m_partitionCount(1), m_partition(0)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		const ULONG streamLimit = (ULONG) MIN(memoryLimit / streamCount, MAX_ULONG);
+
+		m_tables = FB_NEW_POOL(pool) CollisionTable*[streamCount];
+
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_tables[i] = FB_NEW_POOL(pool) CollisionTable(pool, streamLimit);
 	}
 
 	~HashTable()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
+		for (ULONG i = 0; i < m_streamCount; i++)
+			delete m_tables[i];
 
-		delete[] m_collisions;
+		delete[] m_tables;
 	}
 
-	void put(ULONG stream, ULONG hash, ULONG position)
+	void reserve(ULONG stream, double cardinality)
 	{
-		const ULONG slot = hash % m_tableSize;
-
 		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
 
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
+		// Don't trust the optimizer estimation blindly, it may be way too high
+		const ULONG count = (ULONG) MIN(cardinality, (double) HASH_PREALLOCATE_LIMIT);
+		m_tables[stream]->reserve(count);
+	}
 
-		if (!collisions)
-		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
-		}
+	void put(ULONG stream, ULONG hash, ULONG position)
+	{
+		fb_assert(stream < m_streamCount);
 
-		collisions->add(hash, position);
+		m_tables[stream]->add(hash, position);
 	}
 
 	bool setup(ULONG hash)
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(isResident(hash));
 
 		for (ULONG i = 0; i < m_streamCount; i++)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
-
-			if (!collisions)
-				return false;
-
-			if (!collisions->locate(hash))
+			if (!m_tables[i]->locate(hash))
 				return false;
 		}
 
-		m_slot = slot;
 		return true;
 	}
 
@@ -186,34 +440,102 @@ public:
 	{
 		fb_assert(stream < m_streamCount);
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		m_tables[stream]->locate(hash);
 	}
 
 	bool iterate(ULONG stream, ULONG hash, ULONG& position)
 	{
 		fb_assert(stream < m_streamCount);
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+		return m_tables[stream]->iterate(hash, position);
 	}
 
-	void sort()
+	void build()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-		{
-			CollisionList* const collisions = m_collisions[i];
+		// If some of the streams did not fit the memory limit, process the spilled ones
+		// partition by partition, using as many partitions as necessary for every
+		// partition to fit the limit. The streams fitting the limit are kept resident.
+		// The first partition is processed while the leading stream is being read
+		// (hybrid hash join), the other ones are processed one by one afterwards.
 
-			if (collisions)
-				collisions->sort();
-		}
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_partitionCount = MAX(m_partitionCount, m_tables[i]->getPartitionCount());
+
+		fb_assert(m_partitionCount == 1 || m_memoryLimit);
+
+		m_partition = 0;
+		load();
+	}
+
+	bool isPartitioned() const
+	{
+		return (m_partitionCount > 1);
+	}
+
+	ULONG getPartition() const
+	{
+		return m_partition;
+	}
+
+	bool isResident(ULONG hash) const
+	{
+		return (hash & (m_partitionCount - 1)) == m_partition;
+	}
+
+	void defer(ULONG hash, ULONG position)
+	{
+		fb_assert(m_partition == 0 && !isResident(hash));
+
+		if (!m_deferred)
+			m_deferred = FB_NEW_POOL(getPool()) SpillFile(getPool());
+
+		m_deferred->put(Entry(hash, position));
+	}
+
+	bool getDeferred(ULONG& hash, ULONG& position)
+	{
+		fb_assert(m_partition > 0 && m_deferred);
+
+		Entry entry;
+		if (!m_deferred->get(entry))
+			return false;
+
+		fb_assert(isResident(entry.hash));
+
+		hash = entry.hash;
+		position = entry.position;
+		return true;
+	}
+
+	bool nextPartition()
+	{
+		if (!m_deferred)
+			return false;
+
+		if (m_partition == 0)
+			m_deferred->flush();
+
+		if (++m_partition >= m_partitionCount)
+			return false;
+
+		m_deferred->rewind(m_partitionCount - 1, m_partition);
+		load();
+		return true;
 	}
 
 private:
+	void load()
+	{
+		for (ULONG i = 0; i < m_streamCount; i++)
+			m_tables[i]->build(m_partitionCount - 1, m_partition);
+	}
+
 	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
+	const FB_UINT64 m_memoryLimit;
+	CollisionTable** m_tables;
+	AutoPtr<SpillFile> m_deferred;	// leading records waiting for their partitions
+	ULONG m_partitionCount;
+	ULONG m_partition;
 };
 
 
@@ -221,7 +543,8 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 				   RecordSource* const* args, NestValueArray* const* keys,
 				   double selectivity)
 	: RecordSource(csb),
-	  m_args(csb->csb_pool, count - 1)
+	  m_args(csb->csb_pool, count - 1),
+	  m_memoryLimit(0)
 {
 	fb_assert(count >= 2);
 
@@ -308,6 +631,15 @@ HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 	}
 
 	m_cardinality *= selectivity;
+
+	// If the hash table exceeds the memory limit at runtime, it's going to be partitioned.
+	// Then the leading records of the partitions not loaded yet are cached by the buffer,
+	// to be processed later.
+
+	m_memoryLimit = tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit();
+
+	if (m_memoryLimit)
+		m_leader.buffer = FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_leader.source);
 }
 
 void HashJoin::internalOpen(thread_db* tdbb) const
@@ -346,6 +678,9 @@ void HashJoin::close(thread_db* tdbb) const
 		for (FB_SIZE_T i = 0; i < m_args.getCount(); i++)
 			m_args[i].buffer->close(tdbb);
 
+		if (m_leader.buffer)
+			m_leader.buffer->close(tdbb);
+
 		m_leader.source->close(tdbb);
 	}
 }
@@ -364,47 +699,98 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	{
 		if (impure->irsb_flags & irsb_mustread)
 		{
-			// Fetch the record from the leading stream
+			const auto hashTable = impure->irsb_hash_table;
 
-			if (!m_leader.source->getRecord(tdbb))
-				return false;
+			if (hashTable && hashTable->getPartition())
+			{
+				// Fetch the next leading record waiting for the current partition
 
-			// We have something to join with, so ensure the hash table is initialized
+				ULONG position;
+				if (!hashTable->getDeferred(impure->irsb_leader_hash, position))
+				{
+					if (!hashTable->nextPartition())
+						return false;
+
+					continue;
+				}
 
-			if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
+				m_leader.buffer->locate(tdbb, position);
+
+				if (!m_leader.buffer->getRecord(tdbb))
+				{
+					fb_assert(false);
+					return false;
+				}
+			}
+			else
 			{
-				auto& pool = *tdbb->getDefaultPool();
-				const auto argCount = m_args.getCount();
+				// Fetch the record from the leading stream
+
+				if (!m_leader.source->getRecord(tdbb))
+				{
+					// Continue with the partitions postponed, if any
+
+					if (hashTable && hashTable->nextPartition())
+						continue;
 
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
-				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+					return false;
+				}
 
-				UCharBuffer buffer(pool);
+				// We have something to join with, so ensure the hash table is initialized
 
-				for (FB_SIZE_T i = 0; i < argCount; i++)
+				if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
 				{
-					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
+					auto& pool = *tdbb->getDefaultPool();
+					const auto argCount = m_args.getCount();
 
-					m_args[i].buffer->open(tdbb);
+					impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount, m_memoryLimit);
+					impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
 
-					ULONG counter = 0;
-					const auto keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+					UCharBuffer buffer(pool);
 
-					while (m_args[i].buffer->getRecord(tdbb))
+					for (FB_SIZE_T i = 0; i < argCount; i++)
 					{
-						const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
+						// Read and cache the inner streams. While doing that,
+						// hash the join condition values and populate hash tables.
+
+						m_args[i].buffer->open(tdbb);
+
+						// Preallocate the hash table using the optimizer estimation
+						impure->irsb_hash_table->reserve(i, m_args[i].buffer->getCardinality());
+
+						ULONG counter = 0;
+						const auto keyBuffer = buffer.getBuffer(m_args[i].totalKeyLength, false);
+
+						while (m_args[i].buffer->getRecord(tdbb))
+						{
+							const auto hash = computeHash(tdbb, request, m_args[i], keyBuffer);
+							impure->irsb_hash_table->put(i, hash, counter++);
+						}
 					}
+
+					impure->irsb_hash_table->build();
+
+					if (impure->irsb_hash_table->isPartitioned())
+						m_leader.buffer->openSpill(tdbb);
 				}
 
-				impure->irsb_hash_table->sort();
-			}
+				// Compute and hash the comparison keys
+
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+
+				// If the matching partition is not loaded yet, cache the record
+				// and remember its position to process it later
 
-			// Compute and hash the comparison keys
+				if (!impure->irsb_hash_table->isResident(impure->irsb_leader_hash))
+				{
+					fb_assert(m_leader.buffer);
 
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+					const auto position = m_leader.buffer->putSpill(tdbb);
+					impure->irsb_hash_table->defer(impure->irsb_leader_hash, (ULONG) position);
+					continue;
+				}
+			}
 
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
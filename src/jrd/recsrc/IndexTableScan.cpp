@@ -248,6 +248,7 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 			if (node.isEndBucket)
 			{
 				page = (Ods::btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
+				impure->irsb_read_ahead.nextLeaf(tdbb, &window);
 				nextPointer = page->btr_nodes + page->btr_jump_size;
 				continue;
 			}
@@ -268,7 +269,8 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 					if (retrieval->irb_generic & irb_root_list_scan)
 					{
 						CCH_RELEASE(tdbb, &window);
-						page = BTR_find_page(tdbb, retrieval, &window, idx, nextLower, nextUpper);
+						page = BTR_find_page(tdbb, retrieval, &window, idx, nextLower, nextUpper,
+							&impure->irsb_read_ahead);
 						setPage(tdbb, impure, &window);
 					}
 
@@ -632,7 +634,8 @@ UCHAR* IndexTableScan::openStream(thread_db* tdbb, Impure* impure, win* window)
 	const IndexRetrieval* const retrieval = m_index->retrieval;
 	index_desc* const idx = (index_desc*) ((SCHAR*) impure + m_offset);
 
-	Ods::btree_page* page = BTR_find_page(tdbb, retrieval, window, idx, lower, upper);
+	Ods::btree_page* page = BTR_find_page(tdbb, retrieval, window, idx, lower, upper,
+		&impure->irsb_read_ahead);
 	setPage(tdbb, impure, window);
 
 	// find the upper limit for the search
@@ -227,10 +227,13 @@ namespace Jrd
 
 	class FullTableScan final : public RecordStream
 	{
+		class ParallelScan;
+
 		struct Impure : public RecordSource::Impure
 		{
 			RecordNumber irsb_lower;
 			RecordNumber irsb_upper;
+			ParallelScan* irsb_parallel;
 		};
 
 	public:
@@ -295,6 +298,7 @@ namespace Jrd
 			temporary_key* irsb_nav_current_lower;		// current lower key
 			temporary_key* irsb_nav_current_upper;		// current upper key
 			IndexScanListIterator* irsb_iterator;		// key list iterator
+			BtrReadAhead irsb_read_ahead;				// leaf pages read-ahead state
 			USHORT irsb_nav_offset;						// page offset of current index node
 			USHORT irsb_nav_upper_length;				// length of upper key value
 			USHORT irsb_nav_length;						// length of expanded key
@@ -724,11 +728,22 @@ namespace Jrd
 			return m_map->keyLength;
 		}
 
+		RecordSource* getInput()
+		{
+			return m_next;
+		}
+
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
 		UCHAR* getData(thread_db* tdbb) const;
 		void mapData(thread_db* tdbb, Request* request, UCHAR* data) const;
 
+		// Open the stream sorting only the input records passed by the caller,
+		// who opens and reads the input itself (used by the hash aggregation)
+		void openSpill(thread_db* tdbb) const;
+		void putSpill(thread_db* tdbb) const;
+		void sortSpill(thread_db* tdbb) const;
+
 		bool isKey(const dsc* desc) const
 		{
 			return ((ULONG)(IPTR) desc->dsc_address < m_map->keyLength);
@@ -749,6 +764,8 @@ namespace Jrd
 
 	private:
 		Sort* init(thread_db* tdbb) const;
+		Sort* createSort(thread_db* tdbb) const;
+		void putRecord(thread_db* tdbb, Sort* sort) const;
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
@@ -862,6 +879,7 @@ namespace Jrd
 
 	protected:
 		void internalOpen(thread_db* tdbb) const override;
+		void initImpure(thread_db* tdbb) const;
 
 		Impure* getImpure(Request* request) const
 		{
@@ -920,16 +938,44 @@ namespace Jrd
 
 	class AggregatedStream final : public BaseAggWinStream<AggregatedStream, RecordSource>
 	{
+		class HashTable;
+
+	public:
+		struct Impure final : public BaseAggWinStream::Impure
+		{
+			HashTable* hashTable;
+			ULONG hashPosition;
+			bool hashSpilled;
+		};
+
 	public:
 		AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
-			const NestValueArray* group, MapNode* map, RecordSource* next);
+			NestValueArray* group, MapNode* map, RecordSource* next, bool groupOrdered = false);
 
 	public:
+		void close(thread_db* tdbb) const override;
+
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		bool canHash(thread_db* tdbb, CompilerScratch* csb, NestValueArray* group, MapNode* map);
+		bool buildHashTable(thread_db* tdbb, Request* request, HashTable* hashTable) const;
+		ULONG computeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const;
+		void saveState(Request* request, UCHAR* state) const;
+		void restoreState(Request* request, const UCHAR* state) const;
+
+		NestConst<RecordSource> m_hashNext;		// unsorted input, if groups may be hashed
+		NestConst<SortedStream> m_sortedNext;	// sort of the groups not fitting the hash table
+		Firebird::Array<dsc> m_keyDescs;
+		Firebird::Array<ULONG> m_keyLengths;
+		ULONG m_keyLength;
+		ULONG m_stateLength;
+		FB_UINT64 m_memoryLimit;
 	};
 
 	class WindowedStream : public RecordSource
@@ -1119,12 +1165,20 @@ namespace Jrd
 			return impure->irsb_position;
 		}
 
+		// Open the stream caching only the input records passed by the caller,
+		// who opens and reads the input itself (used by the hash join).
+		// putSpill() returns the position of the cached record.
+		void openSpill(thread_db* tdbb) const;
+		FB_UINT64 putSpill(thread_db* tdbb) const;
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
+		FB_UINT64 storeRecord(thread_db* tdbb, Request* request, RecordBuffer* buffer) const;
+
 		NestConst<RecordSource> m_next;
 		Firebird::HalfStaticArray<FieldMap, OPT_STATIC_ITEMS> m_map;
 		const Format* m_format;
@@ -1249,6 +1303,7 @@ namespace Jrd
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_args;
+		FB_UINT64 m_memoryLimit;	// non-zero if the hash table may be partitioned
 	};
 
 	class MergeJoin : public RecordSource
@@ -182,106 +182,147 @@ void SortedStream::nullRecords(thread_db* tdbb) const
 
 Sort* SortedStream::init(thread_db* tdbb) const
 {
-	Request* const request = tdbb->getRequest();
-
 	m_next->open(tdbb);
 
+	AutoPtr<Sort> scb(createSort(tdbb));
+
+	// Pump the input stream dry while pushing records into sort
+
+	while (m_next->getRecord(tdbb))
+		putRecord(tdbb, scb);
+
+	scb->sort(tdbb);
+
+	return scb.release();
+}
+
+Sort* SortedStream::createSort(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
 	// Initialize for sort. If this is really a project operation,
 	// establish a callback routine to reject duplicate records.
 
-	AutoPtr<Sort> scb(FB_NEW_POOL(request->req_sorts.getPool())
+	return FB_NEW_POOL(request->req_sorts.getPool())
 		Sort(tdbb->getDatabase(), &request->req_sorts,
 			 m_map->length, m_map->keyItems.getCount(), m_map->keyItems.getCount(),
 			 m_map->keyItems.begin(),
-			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0));
+			 ((m_map->flags & FLAG_PROJECT) ? rejectDuplicate : nullptr), 0);
+}
 
-	// Pump the input stream dry while pushing records into sort. For
-	// each record, map all fields into the sort record. The reverse
-	// mapping is done in get_sort().
+// Map all fields of the current input record into the sort record.
+// The reverse mapping is done in mapData().
+void SortedStream::putRecord(thread_db* tdbb, Sort* sort) const
+{
+	Request* const request = tdbb->getRequest();
 
 	dsc to, temp;
 
-	while (m_next->getRecord(tdbb))
+	// "Put" a record to sort. Actually, get the address of a place
+	// to build a record.
+
+	UCHAR* data = nullptr;
+	sort->put(tdbb, reinterpret_cast<ULONG**>(&data));
+
+	// Zero out the sort key. This solves a multitude of problems.
+
+	memset(data, 0, m_map->length);
+
+	// Loop thru all field (keys and hangers on) involved in the sort.
+	// Be careful to null field all unused bytes in the sort key.
+
+	const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
+	for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
 	{
-		// "Put" a record to sort. Actually, get the address of a place
-		// to build a record.
+		to = item->desc;
+		to.dsc_address = data + (IPTR) to.dsc_address;
+		bool flag = false;
+		dsc* from = nullptr;
+
+		if (item->node)
+		{
+			from = EVL_expr(tdbb, request, item->node);
+			if (request->req_flags & req_null)
+				flag = true;
+		}
+		else
+		{
+			from = &temp;
 
-		UCHAR* data = nullptr;
-		scb->put(tdbb, reinterpret_cast<ULONG**>(&data));
+			record_param* const rpb = &request->req_rpb[item->stream];
 
-		// Zero out the sort key. This solves a multitude of problems.
+			if (item->fieldId < 0)
+			{
+				switch (item->fieldId)
+				{
+				case ID_TRANS:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
+					break;
+				case ID_DBKEY:
+					*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
+					break;
+				case ID_DBKEY_VALID:
+					*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
+					break;
+				default:
+					fb_assert(false);
+				}
+				continue;
+			}
 
-		memset(data, 0, m_map->length);
+			if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
+				flag = true;
+		}
 
-		// Loop thru all field (keys and hangers on) involved in the sort.
-		// Be careful to null field all unused bytes in the sort key.
+		*(data + item->flagOffset) = flag ? TRUE : FALSE;
 
-		const SortMap::Item* const end_item = m_map->items.begin() + m_map->items.getCount();
-		for (const SortMap::Item* item = m_map->items.begin(); item < end_item; item++)
+		if (!flag)
 		{
-			to = item->desc;
-			to.dsc_address = data + (IPTR) to.dsc_address;
-			bool flag = false;
-			dsc* from = nullptr;
+			// If an INTL string is moved into the key portion of the sort record,
+			// then we want to sort by language dependent order
 
-			if (item->node)
+			if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
 			{
-				from = EVL_expr(tdbb, request, item->node);
-				if (request->req_flags & req_null)
-					flag = true;
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
+					(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
 			}
 			else
 			{
-				from = &temp;
+				MOV_move(tdbb, from, &to);
+			}
+		}
+	}
+}
 
-				record_param* const rpb = &request->req_rpb[item->stream];
+void SortedStream::openSpill(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
-				if (item->fieldId < 0)
-				{
-					switch (item->fieldId)
-					{
-					case ID_TRANS:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_transaction_nr;
-						break;
-					case ID_DBKEY:
-						*reinterpret_cast<SINT64*>(to.dsc_address) = rpb->rpb_number.getValue();
-						break;
-					case ID_DBKEY_VALID:
-						*to.dsc_address = (UCHAR) rpb->rpb_number.isValid();
-						break;
-					default:
-						fb_assert(false);
-					}
-					continue;
-				}
+	impure->irsb_flags = irsb_open;
 
-				if (!EVL_field(rpb->rpb_relation, rpb->rpb_record, item->fieldId, from))
-					flag = true;
-			}
+	delete impure->irsb_sort;
+	impure->irsb_sort = nullptr;
 
-			*(data + item->flagOffset) = flag ? TRUE : FALSE;
+	impure->irsb_sort = createSort(tdbb);
+}
 
-			if (!flag)
-			{
-				// If an INTL string is moved into the key portion of the sort record,
-				// then we want to sort by language dependent order
+void SortedStream::putSpill(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
-				if (IS_INTL_DATA(&item->desc) && isKey(&item->desc))
-				{
-					INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&item->desc), from, &to,
-						(m_map->flags & FLAG_UNIQUE ? INTL_KEY_UNIQUE : INTL_KEY_SORT));
-				}
-				else
-				{
-					MOV_move(tdbb, from, &to);
-				}
-			}
-		}
-	}
+	fb_assert(impure->irsb_sort);
+	putRecord(tdbb, impure->irsb_sort);
+}
 
-	scb->sort(tdbb);
+void SortedStream::sortSpill(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
-	return scb.release();
+	fb_assert(impure->irsb_sort);
+	impure->irsb_sort->sort(tdbb);
 }
 
 bool SortedStream::compareKeys(const UCHAR* p, const UCHAR* q) const
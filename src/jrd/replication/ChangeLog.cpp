@@ -67,6 +67,7 @@ using namespace Replication;
 namespace
 {
 	const unsigned FLUSH_WAIT_INTERVAL = 1; // milliseconds
+	const unsigned MAX_SYNC_WAIT_INTERVAL = 16; // milliseconds
 
 	const unsigned NO_SPACE_TIMEOUT = 10;	// seconds
 	const unsigned NO_SPACE_RETRIES = 6;		// up to one minute
@@ -349,7 +350,8 @@ ChangeLog::ChangeLog(MemoryPool& pool,
 					 const Replication::Config* config)
 	: PermanentStorage(pool),
 	  m_dbId(dbId), m_guid(guid), m_config(config), m_segments(pool),
-	  m_sequence(sequence), m_generation(0), m_shutdown(false)
+	  m_sequence(sequence), m_generation(0), m_syncWaiters(0), m_syncing(false),
+	  m_shutdown(false)
 {
 	initSharedFile();
 
@@ -622,6 +624,7 @@ FB_UINT64 ChangeLog::write(ULONG length, const UCHAR* data, bool sync)
 	fb_assert(segment->getSequence() == state->sequence);
 
 	segment->append(length, data);
+	const auto writeMark = ++state->writeMark;
 
 	if (segment->getLength() > m_config->segmentSize)
 	{
@@ -631,39 +634,134 @@ FB_UINT64 ChangeLog::write(ULONG length, const UCHAR* data, bool sync)
 	}
 
 	if (sync)
+		syncSegment(segment, writeMark);
+
+	return state->sequence;
+}
+
+void ChangeLog::sync()
+{
+	LockGuard guard(this);
+
+	const auto state = m_sharedMemory->getHeader();
+
+	// Full segments are synced when switched, so only the active one matters
+	for (const auto segment : m_segments)
 	{
-		if (m_config->groupFlushDelay)
+		if (segment->getState() == SEGMENT_STATE_USED)
 		{
-			const auto flushMark = state->flushMark;
+			syncSegment(segment, state->writeMark);
+			break;
+		}
+	}
+}
 
-			segment->addRef();
+void ChangeLog::syncSegment(Segment* segment, ULONG writeMark)
+{
+	static const auto process_id = getpid();
+
+	const auto state = m_sharedMemory->getHeader();
+
+	segment->addRef();
+
+	if (m_config->groupFlushDelay)
+	{
+		const auto flushMark = state->flushMark;
+
+		for (ULONG delay = 0; delay < m_config->groupFlushDelay;
+			delay += FLUSH_WAIT_INTERVAL)
+		{
+			if (state->flushMark != flushMark)
+				break;
+
+			LockCheckout checkout(this);
+			Thread::sleep(FLUSH_WAIT_INTERVAL);
+		}
+
+		if (state->flushMark == flushMark)
+		{
+			segment->flush(true);
+			state->syncMark = state->writeMark;
+			state->flushMark++;
+		}
+	}
+	else
+	{
+		// Group commit: the segment is synced outside the lock, on behalf of all
+		// writes done so far. Writers arriving meanwhile wait for that sync to finish
+		// and then are covered either by it or by the next one, done by one of them.
+		// Waiters of this process are woken up by the syncing thread, while waiters
+		// of other processes re-check the shared state with a growing delay.
+		// Our own PID left by a crashed process is detected via m_syncing,
+		// as it's set only while some thread of this process is syncing.
+
+		unsigned delay = FLUSH_WAIT_INTERVAL;
+
+		while ((SLONG) (state->syncMark - writeMark) < 0 &&
+			segment->getState() == SEGMENT_STATE_USED)
+		{
+			const bool ownSync = (state->syncPid == process_id);
 
-			for (ULONG delay = 0; delay < m_config->groupFlushDelay;
-				delay += FLUSH_WAIT_INTERVAL)
+			if (state->syncPid &&
+				(ownSync ? m_syncing : ISC_check_process_existence(state->syncPid)))
 			{
-				if (state->flushMark != flushMark)
-					break;
+				if (ownSync && !m_shutdown)
+				{
+					m_syncWaiters++;
 
-				LockCheckout checkout(this);
-				Thread::sleep(FLUSH_WAIT_INTERVAL);
+					LockCheckout checkout(this);
+					m_syncSemaphore.enter();
+				}
+				else
+				{
+					LockCheckout checkout(this);
+					Thread::sleep(delay);
+					delay = MIN(delay * 2, MAX_SYNC_WAIT_INTERVAL);
+				}
+
+				continue;
 			}
 
-			if (state->flushMark == flushMark)
+			const auto syncMark = state->writeMark;
+			state->syncPid = process_id;
+			m_syncing = true;
+
+			try
 			{
+				LockCheckout checkout(this);
 				segment->flush(true);
-				state->flushMark++;
+			}
+			catch (const Exception&)
+			{
+				state->syncPid = 0;
+				m_syncing = false;
+				wakeSyncWaiters();
+				segment->release();
+				throw;
 			}
 
-			segment->release();
-		}
-		else
-		{
-			segment->flush(true);
+			state->syncPid = 0;
+			m_syncing = false;
+
+			// Never move the mark backwards if a later sync has finished meanwhile
+			if ((SLONG) (syncMark - state->syncMark) > 0)
+				state->syncMark = syncMark;
+
 			state->flushMark++;
+			wakeSyncWaiters();
 		}
 	}
 
-	return state->sequence;
+	segment->release();
+}
+
+void ChangeLog::wakeSyncWaiters()
+{
+	if (m_syncWaiters)
+	{
+		m_syncSemaphore.release(m_syncWaiters);
+		m_syncWaiters = 0;
+	}
 }
 
 bool ChangeLog::archiveExecute(Segment* segment)
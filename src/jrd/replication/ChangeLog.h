@@ -70,6 +70,9 @@ namespace Replication
 			time_t timestamp;			// timestamp of last write
 			ULONG generation;			// segments reload marker
 			ULONG flushMark;			// last flush mark
+			ULONG writeMark;			// last write mark
+			ULONG syncMark;				// last write mark known to be synced
+			int syncPid;				// PID of the process syncing the active segment
 			FB_UINT64 sequence;			// sequence number of the last segment
 			ULONG pidLower;				// lower boundary mark in the PID array
 			ULONG pidUpper;				// upper boundary mark in the PID array
@@ -77,7 +80,7 @@ namespace Replication
 		};
 
 		// Shared memory layout format
-		static const USHORT STATE_VERSION = 1;
+		static const USHORT STATE_VERSION = 2;
 		// Mapping size (not extendable for the time being)
 		static const ULONG STATE_MAPPING_SIZE = 64 * 1024;	// 64 KB
 		// Max number of processes accessing the shared state
@@ -211,6 +214,7 @@ namespace Replication
 
 		void forceSwitch();
 		FB_UINT64 write(ULONG length, const UCHAR* data, bool sync);
+		void sync();
 
 		void bgArchiver();
 
@@ -246,6 +250,8 @@ namespace Replication
 		bool archiveSegment(Segment*);
 
 		void switchActiveSegment();
+		void syncSegment(Segment* segment, ULONG writeMark);
+		void wakeSyncWaiters();
 
 		const Firebird::string& m_dbId;
 		const Firebird::Guid& m_guid;
@@ -259,6 +265,9 @@ namespace Replication
 		Firebird::Semaphore m_startupSemaphore;
 		Firebird::Semaphore m_cleanupSemaphore;
 		Firebird::Semaphore m_workingSemaphore;
+		Firebird::Semaphore m_syncSemaphore;
+		ULONG m_syncWaiters;
+		bool m_syncing;
 
 		volatile bool m_shutdown;
 	};
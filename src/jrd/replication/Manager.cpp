@@ -102,6 +102,9 @@ Manager::Manager(const string& dbId,
 	  m_buffers(getPool()),
 	  m_queue(getPool()),
 	  m_queueSize(0),
+	  m_pending(getPool()),
+	  m_writeMark(0),
+	  m_syncMark(0),
 	  m_shutdown(false),
 	  m_signalled(false)
 {
@@ -187,6 +190,7 @@ Manager::~Manager()
 {
 	fb_assert(m_shutdown);
 	fb_assert(m_queue.isEmpty());
+	fb_assert(m_pending.isEmpty());
 	fb_assert(m_replicas.isEmpty());
 
 	for (auto buffer : m_buffers)
@@ -215,6 +219,11 @@ void Manager::shutdown()
 
 	m_queue.clear();
 
+	for (const auto& pending : m_pending)
+		releaseBuffer(pending.buffer);
+
+	m_pending.clear();
+
 	// Detach from synchronous replicas
 
 	for (auto iter : m_replicas)
@@ -296,7 +305,7 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 
 					if (hasData)
 					{
-						const auto sequence = m_changeLog->write(length, buffer->begin(), sync);
+						const auto sequence = m_changeLog->write(length, buffer->begin(), false);
 
 						if (sequence != m_sequence)
 						{
@@ -313,23 +322,35 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 					}
 				}
 
-				for (auto iter : m_replicas)
-				{
-					if (iter->status.isSuccess())
-						iter->replicator->process(&iter->status, length, buffer->begin());
-				}
-
-				m_queueSize -= length;
-				releaseBuffer(buffer);
+				addPending(buffer, sync && m_changeLog.hasData());
 				buffer = nullptr;
-
-				for (auto iter : m_replicas)
-					iter->status.check();
 			}
 		}
 
 		m_queue.clear();
-		m_queueSize = 0;
+
+		// The journal is synced before the buffers are sent to synchronous replicas.
+		// This is done without holding the queue, so concurrent committers are synced
+		// together. Our buffers may be also delayed by a concurrent sync of the former
+		// ones, then we sync the journal ourselves.
+
+		const auto writeMark = m_writeMark;
+
+		if (sync && m_changeLog)
+			syncJournal();
+
+		sendPending();
+
+		if (m_pending.hasData() && m_pending.front().mark <= writeMark)
+		{
+			syncJournal();
+			sendPending();
+		}
+
+		fb_assert(m_pending.isEmpty() || m_pending.front().mark > writeMark);
+
+		for (auto iter : m_replicas)
+			iter->status.check();
 	}
 	else if (!m_signalled)
 	{
@@ -338,6 +359,74 @@ void Manager::flush(UCharBuffer* buffer, bool sync, bool prepare)
 	}
 }
 
+void Manager::addPending(UCharBuffer* buffer, bool sync)
+{
+	PendingBuffer pending;
+	pending.buffer = buffer;
+	pending.mark = ++m_writeMark;
+	pending.sync = sync;
+
+	m_pending.add(pending);
+}
+
+void Manager::syncJournal()
+{
+	fb_assert(m_changeLog);
+
+	// All the buffers written so far are covered by the sync
+	const auto writeMark = m_writeMark;
+
+	try
+	{
+		MutexUnlockGuard cout(m_queueMutex, FB_FUNCTION);
+		m_changeLog->sync();
+	}
+	catch (const Exception&)
+	{
+		// Don't let the buffers waiting for the failed sync block sending
+		// of the following ones, by bgWriter() in particular
+		for (auto& pending : m_pending)
+		{
+			if (pending.mark <= writeMark)
+				pending.sync = false;
+		}
+
+		throw;
+	}
+
+	if (m_syncMark < writeMark)
+		m_syncMark = writeMark;
+}
+
+void Manager::sendPending()
+{
+	// Send the pending buffers in the journal order, stop at the first one
+	// that is not synced yet
+
+	FB_SIZE_T count = 0;
+
+	for (const auto& pending : m_pending)
+	{
+		if (pending.sync && pending.mark > m_syncMark)
+			break;
+
+		const auto buffer = pending.buffer;
+		const auto length = (ULONG) buffer->getCount();
+
+		for (auto iter : m_replicas)
+		{
+			if (iter->status.isSuccess())
+				iter->replicator->process(&iter->status, length, buffer->begin());
+		}
+
+		m_queueSize -= length;
+		releaseBuffer(buffer);
+		count++;
+	}
+
+	m_pending.removeRange(0, count);
+}
+
 void Manager::bgWriter()
 {
 	try
@@ -362,18 +451,14 @@ void Manager::bgWriter()
 					if (m_changeLog)
 						m_changeLog->write(length, buffer->begin(), false);
 
-					for (auto iter : m_replicas)
-					{
-						if (iter->status.isSuccess())
-							iter->replicator->process(&iter->status, length, buffer->begin());
-					}
-
-					m_queueSize -= length;
-					releaseBuffer(buffer);
+					addPending(buffer, false);
 					buffer = nullptr;
 				}
 			}
 
+			m_queue.clear();
+			sendPending();
+
 			guard.release();
 
 			if (m_shutdown)
@@ -66,6 +66,14 @@ namespace Replication
 			Firebird::IReplicator* replicator;
 		};
 
+		// Buffer written into the journal but not yet sent to synchronous replicas
+		struct PendingBuffer
+		{
+			Firebird::UCharBuffer* buffer;
+			FB_UINT64 mark;		// journal write mark
+			bool sync;			// to be sent only after the journal is synced up to its mark
+		};
+
 	public:
 		Manager(const Firebird::string& dbId, const Replication::Config* config);
 		~Manager();
@@ -89,6 +97,9 @@ namespace Replication
 		}
 
 	private:
+		void addPending(Firebird::UCharBuffer* buffer, bool sync);
+		void syncJournal();
+		void sendPending();
 		void bgWriter();
 
 		static THREAD_ENTRY_DECLARE writer_thread(THREAD_ENTRY_PARAM arg)
@@ -109,6 +120,9 @@ namespace Replication
 		Firebird::Array<Firebird::UCharBuffer*> m_queue;
 		Firebird::Mutex m_queueMutex;
 		ULONG m_queueSize;
+		Firebird::Array<PendingBuffer> m_pending;
+		FB_UINT64 m_writeMark;
+		FB_UINT64 m_syncMark;
 		FB_UINT64 m_sequence;
 
 		volatile bool m_shutdown;
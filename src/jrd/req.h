@@ -64,7 +64,8 @@ struct record_param
 		  rpb_b_page(0), rpb_b_line(0),
 		  rpb_address(NULL), rpb_length(0),
 		  rpb_flags(0), rpb_stream_flags(0), rpb_runtime_flags(0),
-		  rpb_org_scans(0), rpb_window(DB_PAGE_SPACE, -1)
+		  rpb_org_scans(0), rpb_prefetch_seq(0), rpb_prefetch_depth(0),
+		  rpb_window(DB_PAGE_SPACE, -1)
 	{
 	}
 
@@ -91,6 +92,8 @@ struct record_param
 	USHORT rpb_stream_flags;		// stream flags
 	USHORT rpb_runtime_flags;		// runtime flags
 	SSHORT rpb_org_scans;			// relation scan count at stream open
+	ULONG rpb_prefetch_seq;			// next data page sequence to read ahead
+	USHORT rpb_prefetch_depth;		// current read-ahead depth, in pages
 
 	inline WIN& getWindow(thread_db* tdbb)
 	{
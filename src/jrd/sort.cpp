@@ -41,6 +41,7 @@
 #include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
+#include "../common/Task.h"
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -64,6 +65,11 @@
 
 const USHORT RUN_GROUP			= 8;
 const USHORT MAX_MERGE_LEVEL	= 2;
+const USHORT MIN_PARALLEL_RUNS	= RUN_GROUP * 2;
+
+// Radix sort is used instead of quicksort for short keys and big enough buffers
+const ULONG RADIX_MAX_KEY_LONGS		= 4;
+const ULONG RADIX_MIN_RECORDS		= 256;
 
 using namespace Jrd;
 using namespace Firebird;
@@ -150,6 +156,115 @@ namespace
 } // namespace
 
 
+// Task to merge groups of runs in parallel
+
+class Sort::MergeTask : public Task
+{
+public:
+	class Item : public Task::WorkItem
+	{
+	public:
+		explicit Item(MergeTask* task)
+			: Task::WorkItem(task),
+			  m_streams(NULL), m_count(0), m_blocks(NULL),
+			  m_target(NULL), m_buffer(NULL), m_size(0)
+		{}
+
+		run_merge_hdr** m_streams;	// runs to merge
+		ULONG m_count;				// number of runs
+		merge_control* m_blocks;	// merge tree nodes, m_count - 1 of them
+		run_control* m_target;		// resulting run
+		UCHAR* m_buffer;			// output buffer
+		ULONG m_size;				// output buffer size
+	};
+
+	MergeTask(Sort* sort, MemoryPool& pool)
+		: m_pool(pool), m_sort(sort), m_items(pool), m_next(0), m_stop(false)
+	{}
+
+	~MergeTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	Item* addItem()
+	{
+		Item* const item = FB_NEW_POOL(m_pool) Item(this);
+		m_items.add(item);
+		return item;
+	}
+
+	bool handler(WorkItem& _item) override
+	{
+		Item* const item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb;
+		tdbb->setDatabase(m_sort->m_dbb);
+
+		try
+		{
+			m_sort->mergeGroup(item->m_streams, item->m_count, item->m_blocks,
+				item->m_target, item->m_buffer, item->m_size);
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool getWorkItem(WorkItem** pItem) override
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop || m_next >= m_items.getCount())
+			return false;
+
+		*pItem = m_items[m_next++];
+		return true;
+	}
+
+	bool getResult(IStatus* status) override
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers() override
+	{
+		return m_items.getCount();
+	}
+
+private:
+	void setError(IStatus* status)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_status.isSuccess())
+			m_status.save(status);
+
+		m_stop = true;
+	}
+
+	MemoryPool& m_pool;
+	Sort* const m_sort;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	FB_SIZE_T m_next;
+	StatusHolder m_status;
+	volatile bool m_stop;
+};
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -459,6 +574,13 @@ void Sort::sort(thread_db* tdbb)
 			CHECK_FILE(NULL);
 		}
 
+		// If parallel workers are allowed, merge groups of runs into bigger runs
+		// using multiple threads. This way, the final merge (performed record by
+		// record by the caller) has to walk a much lower merge tree.
+
+		mergeParallel(tdbb);
+		CHECK_FILE(NULL);
+
 		// Build a merge tree for the run_control blocks. Start by laying them all out
 		// in a vector. This is done to allow us to build a merge tree from the
 		// bottom up, ensuring that a balanced tree is built.
@@ -1225,7 +1347,14 @@ sort_record* Sort::getMerge(merge_control* merge)
 			l = (ULONG) (run->run_end_buffer - run->run_buffer);
 			n = run->run_records * m_longs * sizeof(ULONG);
 			l = MIN(l, n);
-			run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
+
+			if (m_flags & scb_merge_parallel)
+			{
+				MutexLockGuard guard(m_space_mutex, FB_FUNCTION);
+				run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
+			}
+			else
+				run->run_seek = readBlock(m_space, run->run_seek, run->run_buffer, l);
 
 			record = reinterpret_cast<sort_record*>(run->run_buffer);
 			run->run_record =
@@ -1512,6 +1641,268 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 }
 
 
+void Sort::mergeGroup(run_merge_hdr** streams, ULONG count, merge_control* blocks,
+					  run_control* target, UCHAR* buffer, ULONG size)
+{
+/**************************************
+ *
+ * Merge the given runs into the target run which space is already
+ * allocated in the scratch file. Called by parallel merge workers,
+ * so access to the scratch file must be synchronized.
+ *
+ **************************************/
+	fb_assert(count > 1);
+
+	// Build merge tree bottom up.
+	//
+	// See also kissing cousins of this loop in sort() and mergeRuns()
+
+	merge_control* merge = blocks;
+
+	while (count > 1)
+	{
+		run_merge_hdr** m1 = streams;
+		run_merge_hdr** m2 = streams;
+
+		while (count >= 2)
+		{
+			merge->mrg_header.rmh_type = RMH_TYPE_MRG;
+
+			// garbage watch
+			fb_assert(((*m1)->rmh_type == RMH_TYPE_MRG) || ((*m1)->rmh_type == RMH_TYPE_RUN));
+
+			(*m1)->rmh_parent = merge;
+			merge->mrg_stream_a = *m1++;
+
+			// garbage watch
+			fb_assert(((*m1)->rmh_type == RMH_TYPE_MRG) || ((*m1)->rmh_type == RMH_TYPE_RUN));
+
+			(*m1)->rmh_parent = merge;
+			merge->mrg_stream_b = *m1++;
+
+			merge->mrg_record_a = NULL;
+			merge->mrg_record_b = NULL;
+			*m2++ = (run_merge_hdr*) merge;
+			merge++;
+			count -= 2;
+		}
+
+		if (count)
+			*m2++ = *m1++;
+
+		count = m2 - streams;
+	}
+
+	--merge;
+	merge->mrg_header.rmh_parent = NULL;
+
+	// Merge records into the target run
+
+	const ULONG rec_size = m_longs << SHIFTLONG;
+	const UCHAR* const end = buffer + (size / rec_size) * rec_size;
+	FB_UINT64 seek = target->run_seek;
+	UCHAR* ptr = buffer;
+
+	target->run_records = 0;
+
+	const sort_record* record;
+	while ( (record = getMerge(merge)) )
+	{
+		if (ptr >= end)
+		{
+			MutexLockGuard guard(m_space_mutex, FB_FUNCTION);
+			seek = writeBlock(m_space, seek, buffer, ptr - buffer);
+			ptr = buffer;
+		}
+
+		memcpy(ptr, record, rec_size);
+		ptr += rec_size;
+		++target->run_records;
+	}
+
+	if (ptr > buffer)
+	{
+		MutexLockGuard guard(m_space_mutex, FB_FUNCTION);
+		seek = writeBlock(m_space, seek, buffer, ptr - buffer);
+	}
+
+	fb_assert(seek == target->run_seek + target->run_size);
+}
+
+
+void Sort::mergeParallel(thread_db* tdbb)
+{
+/**************************************
+ *
+ * Split the runs into groups (one per parallel worker) and merge
+ * every group into a single run using the worker threads.
+ *
+ **************************************/
+
+	// Duplicates are rejected using the callback that is not expected to be thread-safe
+	if (m_dup_callback)
+		return;
+
+	const Attachment* const att = tdbb->getAttachment();
+	const ULONG workers = (att && att->att_parallel_workers > 0) ? att->att_parallel_workers : 1;
+
+	ULONG run_count = 0;
+	for (run_control* run = m_runs; run; run = run->run_next)
+		++run_count;
+
+	if (workers < 2 || run_count < MIN_PARALLEL_RUNS)
+		return;
+
+	const ULONG groups = MIN(workers, run_count / RUN_GROUP);
+	fb_assert(groups > 1);
+
+	MemoryPool& pool = m_owner->getPool();
+
+	// Records in runs don't have back pointers
+	const ULONG rec_size = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) << SHIFTLONG;
+
+	// Divide the sort buffer the same way mergeRuns() does: one half is shared
+	// by the runs being read, another half by the runs being written. If the
+	// runs are too many to get a reasonable buffer each, merge them serially.
+
+	const ULONG buffers = m_size_memory / rec_size;
+	const ULONG run_buffer_size = rec_size * (buffers / (2 * run_count));
+	const ULONG output_size = rec_size * (buffers / (2 * groups));
+
+	if (run_buffer_size < rec_size * MIN_RECORDS_TO_ALLOC)
+		return;
+
+	UCHAR* run_buffer = (UCHAR*) m_first_pointer;
+	UCHAR* output_buffer = run_buffer + run_count * run_buffer_size;
+	fb_assert(output_buffer + groups * output_size <= (UCHAR*) m_first_pointer + m_size_memory);
+
+	// Allocate everything else in advance, so that the workers do not touch
+	// anything but their own runs and the scratch file
+
+	Array<run_merge_hdr*> stream_buffer(pool);
+	run_merge_hdr** const streams = stream_buffer.getBuffer(run_count, false);
+
+	Array<merge_control> blocks(pool);
+	blocks.grow(run_count);
+
+	MergeTask task(this, pool);
+	HalfStaticArray<run_control*, 8> targets(pool);
+
+	m_longs -= SIZEOF_SR_BCKPTR_IN_LONGS;
+
+	try
+	{
+		run_control* run = m_runs;
+		ULONG first = 0;
+
+		for (ULONG group = 0; group < groups; group++)
+		{
+			const ULONG last = (group + 1) * run_count / groups;
+
+			MergeTask::Item* const item = task.addItem();
+			item->m_streams = streams + first;
+			item->m_count = last - first;
+			item->m_blocks = blocks.begin() + first;
+			item->m_buffer = output_buffer;
+			item->m_size = output_size;
+			output_buffer += output_size;
+
+			FB_UINT64 size = 0;
+
+			for (; first < last; first++, run = run->run_next)
+			{
+				fb_assert(!run->run_buff_alloc && !run->run_mem_size);
+
+				run->run_buffer = run_buffer;
+				run_buffer += run_buffer_size;
+				run->run_end_buffer = run->run_buffer + run_buffer_size;
+				run->run_record = reinterpret_cast<sort_record*>(run->run_end_buffer);
+				run->run_buff_cache = false;
+
+				streams[first] = (run_merge_hdr*) run;
+				size += run->run_size;
+			}
+
+			run_control* target = m_free_runs;
+
+			if (target)
+				m_free_runs = target->run_next;
+			else
+				target = (run_control*) FB_NEW_POOL(pool) run_control;
+
+			memset(target, 0, sizeof(run_control));
+			targets.add(target);
+
+			target->run_header.rmh_type = RMH_TYPE_RUN;
+			target->run_depth = MAX_MERGE_LEVEL;
+			target->run_size = size;
+			target->run_seek = m_space->allocateSpace(size);
+
+			item->m_target = target;
+		}
+
+		fb_assert(!run && first == run_count);
+
+		Coordinator coord(m_dbb->dbb_permanent);
+
+		{
+			EngineCheckout cout(tdbb, FB_FUNCTION);
+
+			m_flags |= scb_merge_parallel;
+			coord.runSync(&task);
+			m_flags &= ~scb_merge_parallel;
+		}
+
+		FbLocalStatus local_status;
+		if (!task.getResult(&local_status))
+			local_status.raise();
+	}
+	catch (const Exception&)
+	{
+		m_flags &= ~scb_merge_parallel;
+
+		// Let the sort destructor release the allocated runs
+
+		for (auto target : targets)
+		{
+			target->run_next = m_free_runs;
+			m_free_runs = target;
+		}
+
+		for (run_control* run = m_runs; run; run = run->run_next)
+			run->run_buffer = NULL;
+
+		m_longs += SIZEOF_SR_BCKPTR_IN_LONGS;
+		throw;
+	}
+
+	// Release the merged runs and replace them with the resulting ones
+
+	while (run_count--)
+	{
+		run_control* const run = m_runs;
+		m_runs = run->run_next;
+
+		fb_assert(!run->run_records);
+		m_space->releaseSpace(run->run_seek - run->run_size, run->run_size);
+
+		run->run_buffer = NULL;
+		run->run_next = m_free_runs;
+		m_free_runs = run;
+	}
+
+	fb_assert(!m_runs);
+
+	for (auto target : targets)
+	{
+		target->run_next = m_runs;
+		m_runs = target;
+	}
+
+	m_longs += SIZEOF_SR_BCKPTR_IN_LONGS;
+}
+
+
 void Sort::mergeRuns(USHORT n)
 {
 /**************************************
@@ -1857,6 +2248,85 @@ void Sort::quick(SLONG size, SORTP** pointers, ULONG length)
 }
 
 
+void Sort::radix(SLONG size, SORTP** pointers, SORTP** temp, ULONG length)
+{
+/**************************************
+ *
+ * Sort an array of record pointers using LSD radix sort,
+ * treating every byte of the key as a digit. The routine assumes:
+ *
+ * a.  Each element in the array points to the key of a record.
+ *
+ * b.  Keys can be compared by unsigned longword compares,
+ *     so the first longword is the most significant one.
+ *
+ * c.  Keys are short, so that the number of digits is small.
+ *
+ * The sort is stable, so records with equal keys retain their
+ * relative order. Back pointers of the records are NOT updated.
+ *
+ **************************************/
+	const ULONG digits = length * sizeof(SORTP);
+	fb_assert(length <= RADIX_MAX_KEY_LONGS);
+
+	// Count occurrences of every digit value in a single pass
+
+	ULONG counts[RADIX_MAX_KEY_LONGS * sizeof(SORTP)][256];
+	memset(counts, 0, digits * sizeof(counts[0]));
+
+	for (SORTP** ptr = pointers; ptr < pointers + size; ptr++)
+	{
+		const SORTP* const key = *ptr;
+
+		for (ULONG i = 0; i < length; i++)
+		{
+			const SORTP value = key[i];
+			ULONG (*const count)[256] = counts + i * sizeof(SORTP);
+
+			count[0][value & 0xFF]++;
+			count[1][(value >> 8) & 0xFF]++;
+			count[2][(value >> 16) & 0xFF]++;
+			count[3][value >> 24]++;
+		}
+	}
+
+	// Distribute the pointers, starting with the least significant digit,
+	// i.e. the lowest byte of the last longword. Digits having the same
+	// value for all the keys don't change the order and thus are skipped.
+
+	SORTP** source = pointers;
+	SORTP** target = temp;
+
+	for (ULONG digit = digits; digit--;)
+	{
+		const ULONG word = digit / sizeof(SORTP);
+		const ULONG shift = (sizeof(SORTP) - 1 - digit % sizeof(SORTP)) * 8;
+		ULONG* const count = counts[word * sizeof(SORTP) + shift / 8];
+
+		if (count[(source[0][word] >> shift) & 0xFF] == (ULONG) size)
+			continue;
+
+		ULONG offset = 0;
+		for (ULONG value = 0; value < 256; value++)
+		{
+			const ULONG n = count[value];
+			count[value] = offset;
+			offset += n;
+		}
+
+		for (SORTP** ptr = source; ptr < source + size; ptr++)
+			target[count[((*ptr)[word] >> shift) & 0xFF]++] = *ptr;
+
+		SORTP** const swap_temp = source;
+		source = target;
+		target = swap_temp;
+	}
+
+	if (source != pointers)
+		memcpy(pointers, source, size * sizeof(SORTP*));
+}
+
+
 ULONG Sort::order()
 {
 /**************************************
@@ -2057,36 +2527,13 @@ void Sort::sortBuffer(thread_db* tdbb)
 
 	*m_next_pointer = reinterpret_cast<sort_record*>(high_key);
 
-	// Next, call QuickSort. Keep in mind that the first pointer is the
+	// Next, sort the pointers. Keep in mind that the first pointer is the
 	// low key and not a record.
 
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
-
-	// Scream through and correct any out of order pairs
-	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
-	{
-		SORTP** i = j;
-		j++;
-		if (**i >= **j)
-		{
-			const SORTP* p = *i;
-			const SORTP* q = *j;
-			ULONG tl = m_longs - 1;
-			while (tl && *p == *q)
-			{
-				p++;
-				q++;
-				tl--;
-			}
-			if (tl && *p > *q) {
-				swap(i, j);
-			}
-		}
-	}
+	sortPointers(j, n, m_longs, m_key_length, m_owner->getPool());
 
 	// If duplicate handling hasn't been requested, we're done
 
@@ -2134,6 +2581,60 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+void Sort::sortPointers(SORTP** pointers, ULONG count, ULONG longs, ULONG keyLength,
+	MemoryPool& pool, bool allowRadix)
+{
+/**************************************
+ *
+ * Order an array of record pointers and set the back pointers
+ * of the records accordingly. Relative array positions "-1" and
+ * "count" must point to the low and high key guards, as quick()
+ * requires. Short keys are sorted by radix(), others by quick()
+ * followed by a pass straightening out partitions of size two.
+ *
+ **************************************/
+	if (allowRadix && count >= RADIX_MIN_RECORDS && keyLength <= RADIX_MAX_KEY_LONGS)
+	{
+		// Keys are short, sort them digit by digit instead of comparing them.
+		// Radix sort doesn't maintain the back pointers, so fix them afterwards.
+
+		Array<SORTP*> temp(pool);
+		radix(count, pointers, temp.getBuffer(count, false), keyLength);
+
+		for (SORTP** ptr = pointers; ptr < pointers + count; ptr++)
+			((SORTP***) (*ptr))[BACK_OFFSET] = ptr;
+
+		return;
+	}
+
+	quick(count, pointers, longs);
+
+	// Scream through and correct any out of order pairs
+	// hvlad: don't compare user keys against high_key
+	SORTP** j = pointers;
+	while (j < pointers + count - 1)
+	{
+		SORTP** i = j;
+		j++;
+		if (**i >= **j)
+		{
+			const SORTP* p = *i;
+			const SORTP* q = *j;
+			ULONG tl = longs - 1;
+			while (tl && *p == *q)
+			{
+				p++;
+				q++;
+				tl--;
+			}
+			if (tl && *p > *q) {
+				swap(i, j);
+			}
+		}
+	}
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
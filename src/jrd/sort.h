@@ -26,6 +26,7 @@
 
 #include "../include/fb_blk.h"
 #include "../common/DecFloat.h"
+#include "../common/classes/locks.h"
 #include "../jrd/TempSpace.h"
 #include "../jrd/align.h"
 
@@ -272,6 +273,7 @@ typedef bool (*FPTR_REJECT_DUP_CALLBACK)(const UCHAR*, const UCHAR*, void*);
 
 const int scb_sorted		= 1;	// stream has been sorted
 const int scb_reuse_buffer	= 2;	// reuse buffer if possible
+const int scb_merge_parallel	= 4;	// runs are being merged by parallel workers
 
 class Sort
 {
@@ -291,6 +293,8 @@ public:
 		return m_flags & scb_sorted;
 	}
 
+	static void sortPointers(SORTP**, ULONG, ULONG, ULONG, MemoryPool&, bool = true);
+
 	static FB_UINT64 readBlock(TempSpace* space, FB_UINT64 seek, UCHAR* address, ULONG length)
 	{
 		const size_t bytes = space->read(seek, address, length);
@@ -306,6 +310,8 @@ public:
 	}
 
 private:
+	class MergeTask;
+
 	void allocateBuffer(MemoryPool&);
 	void releaseBuffer();
 
@@ -314,6 +320,8 @@ private:
 	sort_record* getRecord();
 	ULONG allocate(ULONG, ULONG, bool);
 	void init();
+	void mergeGroup(run_merge_hdr**, ULONG, merge_control*, run_control*, UCHAR*, ULONG);
+	void mergeParallel(Jrd::thread_db*);
 	void mergeRuns(USHORT);
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
@@ -326,6 +334,7 @@ private:
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG);
+	static void radix(SLONG, SORTP**, SORTP**, ULONG);
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -353,6 +362,7 @@ private:
 	ULONG m_max_alloc_size;						// for the run buffer size
 
 	Firebird::Array<sort_key_def> m_description;
+	Firebird::Mutex m_space_mutex;				// serializes scratch file access of parallel merges
 };
 
 
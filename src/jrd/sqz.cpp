@@ -63,6 +63,95 @@ namespace
 		return (length <= MAX_SHORT_RUN) ? 0 :
 			(length <= MAX_MEDIUM_RUN) ? sizeof(USHORT) : sizeof(ULONG);
 	}
+
+	// Record scanning is done a machine word at a time where possible,
+	// byte-by-byte scanning is left for the tails only
+
+	const FB_UINT64 LOW_BYTES = FB_CONST64(0x0101010101010101);
+	const FB_UINT64 HIGH_BITS = FB_CONST64(0x8080808080808080);
+
+	inline FB_UINT64 loadWord(const UCHAR* p)
+	{
+		FB_UINT64 word;
+		memcpy(&word, p, sizeof(word));
+		return word;
+	}
+
+#ifndef WORDS_BIGENDIAN
+	// Offset of the first (lowest addressed) non-zero byte in a non-zero word
+
+	inline unsigned firstByte(FB_UINT64 word)
+	{
+		fb_assert(word);
+#if defined(__GNUC__)
+		return __builtin_ctzll(word) / 8;
+#elif defined(_MSC_VER) && defined(_WIN64)
+		unsigned long index;
+		_BitScanForward64(&index, word);
+		return index / 8;
+#else
+		unsigned n = 0;
+		for (; !(word & 0xFF); word >>= 8)
+			n++;
+		return n;
+#endif
+	}
+#endif
+
+	// Return the first position where three equal bytes start, or end if there's none
+
+	inline const UCHAR* findRepeat(const UCHAR* data, const UCHAR* end)
+	{
+#ifndef WORDS_BIGENDIAN
+		while (end - data >= (ptrdiff_t) sizeof(FB_UINT64) + 2)
+		{
+			const auto word = loadWord(data);
+			const auto diff = (word ^ loadWord(data + 1)) | (word ^ loadWord(data + 2));
+
+			// Mark zero bytes of diff, the lowest mark is always exact
+			const auto zeros = (diff - LOW_BYTES) & ~diff & HIGH_BITS;
+
+			if (zeros)
+				return data + firstByte(zeros);
+
+			data += sizeof(FB_UINT64);
+		}
+#endif
+
+		for (; end - data > 2; data++)
+		{
+			if (data[0] == data[1] && data[0] == data[2])
+				return data;
+		}
+
+		return end;
+	}
+
+	// Return the first position after data where the byte differs from *data, or end
+
+	inline const UCHAR* skipRepeat(const UCHAR* data, const UCHAR* end)
+	{
+		const auto c = *data;
+
+#ifndef WORDS_BIGENDIAN
+		const auto pattern = c * LOW_BYTES;
+
+		while (end - data >= (ptrdiff_t) sizeof(FB_UINT64))
+		{
+			const auto diff = loadWord(data) ^ pattern;
+
+			if (diff)
+				return data + firstByte(diff);
+
+			data += sizeof(FB_UINT64);
+		}
+#endif
+
+		while (data < end && *data == c)
+			data++;
+
+		return data;
+	}
 };
 
 unsigned Compressor::nonCompressableRun(unsigned length)
@@ -117,21 +206,7 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		// Find length of non-compressable run
 
 		if (count >= MIN_COMPRESS_RUN)
-		{
-			auto max = count - 1;
-			fb_assert(max > 1);
-
-			do {
-				if (data[0] == data[1] && data[0] == data[2])
-				{
-					count = data - start;
-					break;
-				}
-
-				data++;
-
-			} while (--max > 1);
-		}
+			count = findRepeat(data, end) - start;
 
 		data = start + count;
 
@@ -147,23 +222,11 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		// Find a compressable run which is long enough.
 		// Avoid compressing too short runs, this badly affects decompression speed.
 
-		auto max = end - data;
-
-		if (max < MIN_COMPRESS_RUN)
+		if (end - data < MIN_COMPRESS_RUN)
 			continue;
 
 		start = data;
-		const auto c = *data;
-
-		do
-		{
-			if (*data != c)
-				break;
-
-			++data;
-
-		} while (--max);
-
+		data = skipRepeat(data, end);
 		count = data - start;
 
 		if (count < MIN_COMPRESS_RUN)
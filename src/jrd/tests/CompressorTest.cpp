@@ -9,6 +9,46 @@ BOOST_AUTO_TEST_SUITE(EngineSuite)
 BOOST_AUTO_TEST_SUITE(CompressorSuite)
 
 
+namespace
+{
+	// Pack and unpack the data, check the round trip and return the packed length
+	ULONG packAndUnpack(const UCHAR* data, ULONG dataLength, bool allowLongRuns = false)
+	{
+		auto& pool = *getDefaultMemoryPool();
+
+		const Compressor dcc(pool, allowLongRuns, false, dataLength, data);
+
+		const auto packedLength = dcc.getPackedLength();
+		Array<UCHAR> packBuffer;
+		dcc.pack(data, packBuffer.getBuffer(packedLength, false));
+
+		Array<UCHAR> unpackBuffer;
+		unpackBuffer.getBuffer(Compressor::getUnpackedLength(packBuffer.getCount(), packBuffer.begin()), false);
+		BOOST_TEST(unpackBuffer.getCount() == dataLength);
+
+		BOOST_TEST(dcc.unpack(packBuffer.getCount(), packBuffer.begin(),
+			unpackBuffer.getCount(), unpackBuffer.begin()) == unpackBuffer.end());
+
+		BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
+
+		return packedLength;
+	}
+
+	// Fill the buffer with bytes that never repeat in adjacent positions
+	void fillNonRepeating(UCHAR* data, ULONG length)
+	{
+		for (ULONG i = 0; i < length; i++)
+			data[i] = (UCHAR) ('A' + i % 26);
+	}
+
+	// Expected packed length of a non-compressable run of up to 127 bytes
+	ULONG literalLength(ULONG length)
+	{
+		return length ? length + 1 : 0;
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE(CompressorTests)
 
 BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
@@ -33,6 +73,86 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(RunAtEveryOffsetTest)
+{
+	// Runs starting and ending both at and between 8-byte word boundaries
+
+	const ULONG dataLength = 64;
+	const ULONG runLengths[] = {8, 9, 15, 16, 17, 24};
+
+	for (const auto runLength : runLengths)
+	{
+		for (ULONG offset = 0; offset + runLength <= dataLength; offset++)
+		{
+			UCHAR data[dataLength];
+			fillNonRepeating(data, dataLength);
+			memset(data + offset, '0', runLength);
+
+			const auto tail = dataLength - offset - runLength;
+			const auto expected = literalLength(offset) + 2 + literalLength(tail);
+
+			BOOST_TEST_INFO("run length " << runLength << " at offset " << offset);
+			BOOST_TEST(packAndUnpack(data, dataLength) == expected);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ShortRunIsNotCompressedTest)
+{
+	// Runs shorter than MIN_COMPRESS_RUN stay inside a single non-compressable run
+
+	const ULONG dataLength = 64;
+
+	for (ULONG runLength = 2; runLength < 8; runLength++)
+	{
+		for (ULONG offset = 0; offset + runLength <= dataLength; offset++)
+		{
+			UCHAR data[dataLength];
+			fillNonRepeating(data, dataLength);
+			memset(data + offset, '0', runLength);
+
+			BOOST_TEST_INFO("run length " << runLength << " at offset " << offset);
+			BOOST_TEST(packAndUnpack(data, dataLength) == literalLength(dataLength));
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ShortInputTest)
+{
+	// Inputs shorter than a word, and just above it, are scanned byte by byte
+
+	for (ULONG dataLength = 1; dataLength <= 18; dataLength++)
+	{
+		UCHAR data[18];
+
+		fillNonRepeating(data, dataLength);
+		BOOST_TEST_INFO("non-repeating input of " << dataLength << " bytes");
+		BOOST_TEST(packAndUnpack(data, dataLength) == literalLength(dataLength));
+
+		memset(data, '0', dataLength);
+		BOOST_TEST_INFO("repeating input of " << dataLength << " bytes");
+		BOOST_TEST(packAndUnpack(data, dataLength) == (dataLength < 8 ? literalLength(dataLength) : 2));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(LongRunTest)
+{
+	// Runs crossing many words and ending mid-word, with and without long runs
+
+	const ULONG dataLength = 1000;
+
+	for (ULONG offset = 0; offset < 9; offset++)
+	{
+		UCHAR data[dataLength];
+		fillNonRepeating(data, dataLength);
+		memset(data + offset, '0', dataLength - offset - 3);
+
+		BOOST_TEST_INFO("long run at offset " << offset);
+		BOOST_TEST(packAndUnpack(data, dataLength, false) < dataLength / 2);
+		BOOST_TEST(packAndUnpack(data, dataLength, true) < dataLength / 2);
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
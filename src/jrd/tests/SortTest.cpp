@@ -0,0 +1,200 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird development team
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  Copyright (c) 2026 the Firebird development team
+ *  and all contributors signed below.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/sort.h"
+#include <algorithm>
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SortSuite)
+
+
+namespace
+{
+	// In-memory sort buffer: records with a back pointer, a key and a data part
+	// holding the original position of the record, surrounded by the key guards
+	class SortBuffer
+	{
+	public:
+		SortBuffer(ULONG count, ULONG keyLength, ULONG (*generate)(ULONG, ULONG))
+			: m_count(count),
+			  m_keyLength(keyLength),
+			  m_longs(ROUNDUP(offsetof(SR, sr_sort_record) + (keyLength + 1) * sizeof(SORTP),
+				FB_ALIGNMENT) / sizeof(SORTP)),
+			  m_memory(*getDefaultMemoryPool()),
+			  m_guards(*getDefaultMemoryPool()),
+			  m_pointers(*getDefaultMemoryPool())
+		{
+			// Keep one spare record, the comparison sort may look past the last one
+			m_memory.getBuffer((count + 1) * m_longs);
+			memset(m_memory.begin(), 0, m_memory.getCount() * sizeof(SORTP));
+
+			m_guards.getBuffer(2 * m_longs);
+			memset(m_guards.begin(), 0, m_longs * sizeof(SORTP));
+			memset(m_guards.begin() + m_longs, 0xFF, m_longs * sizeof(SORTP));
+
+			m_pointers.add(m_guards.begin());
+
+			for (ULONG i = 0; i < count; i++)
+			{
+				SORTP* const key = getRecord(i)->sr_sort_record.sort_record_key;
+
+				for (ULONG j = 0; j < keyLength; j++)
+					key[j] = generate(i, j);
+
+				key[keyLength] = i;
+				m_pointers.add(key);
+			}
+
+			m_pointers.add(m_guards.begin() + m_longs);
+
+			for (ULONG i = 0; i < count; i++)
+				getRecord(i)->sr_bckptr = reinterpret_cast<sort_record**>(&m_pointers[i + 1]);
+		}
+
+		void sort(bool allowRadix)
+		{
+			Sort::sortPointers(m_pointers.begin() + 1, m_count, m_longs, m_keyLength,
+				*getDefaultMemoryPool(), allowRadix);
+		}
+
+		const SORTP* getKey(ULONG n) const
+		{
+			return m_pointers[n + 1];
+		}
+
+		ULONG getPosition(ULONG n) const
+		{
+			return m_pointers[n + 1][m_keyLength];
+		}
+
+		void checkOrder() const
+		{
+			for (ULONG n = 1; n < m_count; n++)
+			{
+				const SORTP* const prior = getKey(n - 1);
+				const SORTP* const current = getKey(n);
+
+				const bool ordered = std::equal(prior, prior + m_keyLength, current) ?
+					getPosition(n - 1) < getPosition(n) :
+					std::lexicographical_compare(prior, prior + m_keyLength, current, current + m_keyLength);
+
+				BOOST_TEST_INFO("record " << n);
+				BOOST_TEST(ordered);
+			}
+		}
+
+		void checkBackPointers() const
+		{
+			for (ULONG n = 0; n < m_count; n++)
+			{
+				const SR* const record = reinterpret_cast<const SR*>(
+					reinterpret_cast<const UCHAR*>(getKey(n)) - offsetof(SR, sr_sort_record));
+
+				BOOST_TEST_INFO("record " << n);
+				BOOST_TEST((record->sr_bckptr == reinterpret_cast<sort_record* const*>(&m_pointers[n + 1])));
+			}
+		}
+
+	private:
+		SR* getRecord(ULONG i)
+		{
+			return reinterpret_cast<SR*>(m_memory.begin() + i * m_longs);
+		}
+
+		const ULONG m_count;
+		const ULONG m_keyLength;
+		const ULONG m_longs;
+		Array<SORTP> m_memory;
+		Array<SORTP> m_guards;
+		Array<SORTP*> m_pointers;
+	};
+
+	// Sort the same records both ways and check they end up in the same order
+	void checkRadixSort(ULONG count, ULONG keyLength, ULONG (*generate)(ULONG, ULONG))
+	{
+		SortBuffer compared(count, keyLength, generate);
+		compared.sort(false);
+		compared.checkOrder();
+		compared.checkBackPointers();
+
+		SortBuffer radixed(count, keyLength, generate);
+		radixed.sort(true);
+		radixed.checkOrder();
+		radixed.checkBackPointers();
+
+		for (ULONG n = 0; n < count; n++)
+		{
+			BOOST_TEST_INFO("record " << n);
+			BOOST_TEST(compared.getPosition(n) == radixed.getPosition(n));
+		}
+	}
+
+	ULONG scramble(ULONG i, ULONG j)
+	{
+		return (i * 2654435761u) ^ (j * 40503u);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(SortTests)
+
+BOOST_AUTO_TEST_CASE(RadixSortDistinctKeysTest)
+{
+	checkRadixSort(1000, 1, [](ULONG i, ULONG j) { return scramble(i, j); });
+	checkRadixSort(1000, 4, [](ULONG i, ULONG j) { return scramble(i, j); });
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortDuplicateKeysTest)
+{
+	// Few distinct values in the high bytes, equal keys keep their input order
+
+	checkRadixSort(1000, 2, [](ULONG i, ULONG j) { return (scramble(i, j) % 7) << 24; });
+	checkRadixSort(1000, 3, [](ULONG i, ULONG j) { return j == 1 ? 0 : scramble(i, j) % 3; });
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortEqualKeysTest)
+{
+	// Every digit is skipped, the input order is kept
+
+	checkRadixSort(500, 2, [](ULONG, ULONG j) { return j; });
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortThresholdsTest)
+{
+	// Too few records or too long keys fall back to the comparison sort
+
+	checkRadixSort(255, 2, [](ULONG i, ULONG j) { return scramble(i, j) % 11; });
+	checkRadixSort(256, 2, [](ULONG i, ULONG j) { return scramble(i, j) % 11; });
+	checkRadixSort(1000, 5, [](ULONG i, ULONG j) { return scramble(i, j) % 11; });
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SortTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SortSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -145,6 +145,20 @@ const USHORT HISTORY_BLOCKS	= 256;
 
 const ULONG MAX_TABLE_LENGTH = SLONG_MAX;
 
+// Upper limit of CPU pauses between two attempts to grab the lock table mutex
+const ULONG MAX_SPIN_BACKOFF = 64;
+
+static inline void spin_pause()
+{
+#if defined(_MSC_VER)
+	YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+	__builtin_ia32_pause();
+#elif defined(__aarch64__)
+	asm volatile("yield");
+#endif
+}
+
 // SRQ_ABS_PTR uses this macro.
 #define SRQ_BASE                    ((UCHAR*) m_sharedMemory->getHeader())
 
@@ -1042,10 +1056,14 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 
 	// Perform a spin wait on the lock table mutex. This should only
 	// be used on SMP machines; it doesn't make much sense otherwise.
+	// Back off exponentially between attempts: when many CPUs compete
+	// for the mutex, back-to-back try-locks just bounce its cache line
+	// between them and slow down the current holder.
 
 	const ULONG spins_to_try = m_acquireSpins ? m_acquireSpins : 1;
 	bool locked = false;
 	ULONG spins = 0;
+	ULONG backoff = 1;
 	while (spins++ < spins_to_try)
 	{
 		if (m_sharedMemory->mutexLockCond())
@@ -1055,6 +1073,15 @@ void LockManager::acquire_shmem(SRQ_PTR owner_offset)
 		}
 
 		m_blockage = true;
+
+		if (spins < spins_to_try)
+		{
+			for (ULONG i = 0; i < backoff; i++)
+				spin_pause();
+
+			if (backoff < MAX_SPIN_BACKOFF)
+				backoff <<= 1;
+		}
 	}
 
 	// If the spin wait didn't succeed then wait forever
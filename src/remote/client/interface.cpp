@@ -3549,6 +3549,7 @@ ITransaction* Statement::execute(CheckStatusWrapper* status, ITransaction* apiTr
 
 		message->msg_address = const_cast<UCHAR*>(in_msg);
 		statement->rsr_flags.clear(Rsr::FETCHED);
+		statement->resetFetchBatch();
 		statement->rsr_format = statement->rsr_bind_format;
 		statement->clearException();
 
@@ -3715,6 +3716,7 @@ ResultSet* Statement::openCursor(CheckStatusWrapper* status, ITransaction* apiTr
 
 		message->msg_address = const_cast<UCHAR*>(in_msg);
 		statement->rsr_flags.clear(Rsr::FETCHED);
+		statement->resetFetchBatch();
 		statement->rsr_format = statement->rsr_bind_format;
 		statement->clearException();
 
@@ -4857,6 +4859,8 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 
 	// Check to see if data is waiting.  If not, solicite data.
 
+	bool requested = false;
+
 	if ((!statement->rsr_flags.test(Rsr::STREAM_END | Rsr::STREAM_ERR) &&
 		!statement->rsr_message->msg_address && !statement->rsr_rows_pending) ||
 		(	// Low in inventory
@@ -4892,8 +4896,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		{
 			if (operation == fetch_next || operation == fetch_prior)
 			{
-				sqldata->p_sqldata_messages = REMOTE_compute_batch_size(
-					port, 0, op_fetch_response, statement->rsr_select_format);
+				sqldata->p_sqldata_messages = REMOTE_adapt_batch_size(port, statement);
 			}
 
 			// Reorder data when the local buffer is half empty
@@ -4922,6 +4925,7 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		// Make the batch request - and force the packet over the wire
 
 		send_packet(port, packet);
+		requested = !statement->rsr_msgs_waiting;
 
 		statement->rsr_batch_count++;
 		statement->rsr_fetch_operation = operation;
@@ -4947,6 +4951,15 @@ bool ResultSet::fetch(CheckStatusWrapper* status, void* buffer, P_FETCH operatio
 		statement->rsr_msgs_waiting < 2	&&			// Have looked ahead for end of batch
 		statement->rsr_rows_pending)
 	{
+		// Nothing left in the buffer while the pipelined batch is still on the way:
+		// the round trip outlasted the local inventory, ask for more next time
+
+		if (!statement->rsr_msgs_waiting && !requested &&
+			(operation == fetch_next || operation == fetch_prior))
+		{
+			statement->rsr_fetch_stalled = true;
+		}
+
 		// Hit end of batch
 		receive_queued_packet(port, statement->rsr_id);
 	}
@@ -8552,7 +8565,7 @@ static void authReceiveResponse(bool havePacket, ClntAuthBlock& cBlock, rem_port
 				n->cstr_length, n->cstr_address, n->cstr_address ? n->cstr_address[0] : 0));
 			if (packet->p_acpd.p_acpt_type & pflag_compress)
 			{
-				port->initCompression();
+				port->initCompression(packet->p_acpd.p_acpt_type & pflag_compress_zstd);
 				port->port_flags |= PORT_compressed;
 			}
 			packet->p_acpd.p_acpt_type &= ptype_MASK;
@@ -95,6 +95,11 @@
 #include <sys/select.h>
 #endif
 
+#if defined(HAVE_SYS_EPOLL_H) && defined(HAVE_POLL)
+#include <sys/epoll.h>
+#define USE_EPOLL
+#endif
+
 #endif // !WIN_NT
 
 const int INET_RETRY_CALL = 5;
@@ -254,10 +259,16 @@ public:
 	Select()
 		: slct_time(0), slct_count(0), slct_poll(*getDefaultMemoryPool()),
 		  slct_ready(*getDefaultMemoryPool())
+#ifdef USE_EPOLL
+		  , slct_epoll(-1), slct_epoll_ready(*getDefaultMemoryPool())
+#endif
 	{ }
 
 	explicit Select(MemoryPool& pool)
 		: slct_time(0), slct_count(0), slct_poll(pool), slct_ready(pool)
+#ifdef USE_EPOLL
+		  , slct_epoll(-1), slct_epoll_ready(pool)
+#endif
 	{ }
 #else
 	Select()
@@ -273,6 +284,14 @@ public:
 	}
 #endif
 
+#ifdef USE_EPOLL
+	~Select()
+	{
+		if (slct_epoll >= 0)
+			close(slct_epoll);
+	}
+#endif
+
 	enum HandleState {SEL_BAD, SEL_DISCONNECTED, SEL_NO_DATA, SEL_READY};
 
 	// set first port to check for readyness
@@ -341,6 +360,18 @@ public:
 			return SEL_READY;
 #endif
 		SOCKET n = port->port_handle;
+#ifdef USE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			FB_SIZE_T pos;
+			if (n >= 0 && slct_epoll_ready.find(n, pos))
+			{
+				slct_epoll_ready.remove(pos);
+				return SEL_READY;
+			}
+			return n < 0 ? (port->port_flags & PORT_disconnect ? SEL_DISCONNECTED : SEL_BAD) : SEL_NO_DATA;
+		}
+#endif
 #if defined(WIN_NT)
 		if (FD_ISSET(n, &slct_fdset))
 		{
@@ -377,6 +408,15 @@ public:
 
 	void unset(SOCKET handle)
 	{
+#ifdef USE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			FB_SIZE_T pos;
+			if (slct_epoll_ready.find(handle, pos))
+				slct_epoll_ready.remove(pos);
+			return;
+		}
+#endif
 #if defined(HAVE_POLL)
 		pollfd* pf = getPollFd(handle);
 		if (pf)
@@ -414,9 +454,68 @@ public:
 #endif // HAVE_POLL
 	}
 
+	// add port of the multi-client server to the set of ports to wait for
+	// assume port_mutex is locked
+	void set(rem_port* port)
+	{
+#ifdef USE_EPOLL
+		// Sockets stay registered in epoll set between passes, thus waiting
+		// doesn't depend on the total number of connections. Closed socket
+		// is removed from epoll set by the kernel.
+
+		const SOCKET handle = port->port_handle;
+		if (port->port_select_handle == handle)
+			return;
+
+		if (slct_epoll < 0)
+		{
+			slct_epoll = epoll_create1(EPOLL_CLOEXEC);
+			if (slct_epoll < 0)
+				system_call_failed::raise("epoll_create1");
+		}
+
+		epoll_event ev;
+		ev.events = EPOLLIN;
+		ev.data.u64 = 0;
+		ev.data.fd = handle;
+
+		if (epoll_ctl(slct_epoll, EPOLL_CTL_ADD, handle, &ev) == 0 || errno == EEXIST)
+			port->port_select_handle = handle;
+		else
+		{
+			// report it as ready, receive() will break bad connection
+			FB_SIZE_T pos;
+			if (!slct_epoll_ready.find(handle, pos))
+				slct_epoll_ready.insert(pos, handle);
+		}
+#else
+		set(port->port_handle);
+#endif
+	}
+
+	// stop waiting for the port which is still linked into ports list
+	// assume port_mutex is locked
+	void remove(rem_port* port)
+	{
+#ifdef USE_EPOLL
+		if (port->port_select_handle == INVALID_SOCKET)
+			return;
+
+		if (port->port_select_handle == port->port_handle)
+		{
+			epoll_event ev;	// ignored, but must be not NULL for old kernels
+			epoll_ctl(slct_epoll, EPOLL_CTL_DEL, port->port_handle, &ev);
+		}
+		port->port_select_handle = INVALID_SOCKET;
+#endif
+	}
+
 	void clear()
 	{
 		slct_count = 0;
+#ifdef USE_EPOLL
+		slct_epoll_ready.clear();
+#endif
 #if defined(HAVE_POLL)
 		slct_poll.clear();
 #else
@@ -432,6 +531,31 @@ public:
 
 	void select(timeval* timeout)
 	{
+#ifdef USE_EPOLL
+		if (slct_epoll >= 0)
+		{
+			// don't wait if some sockets failed to register
+			const int milliseconds = slct_epoll_ready.hasData() ? 0 :
+				timeout ? timeout->tv_sec * 1000 + timeout->tv_usec / 1000 : -1;
+
+			epoll_event events[SEL_MAX_EVENTS];
+			slct_count = ::epoll_wait(slct_epoll, events, SEL_MAX_EVENTS, milliseconds);
+
+			if (slct_count >= 0)
+			{
+				for (int i = 0; i < slct_count; i++)
+				{
+					FB_SIZE_T pos;
+					if (!slct_epoll_ready.find(events[i].data.fd, pos))
+						slct_epoll_ready.insert(pos, events[i].data.fd);
+				}
+
+				slct_count = slct_epoll_ready.getCount();
+			}
+			return;
+		}
+#endif
+
 #ifdef HAVE_POLL
 		slct_ready.clear();
 		bool hasRequest = false;
@@ -490,6 +614,13 @@ private:
 
 	SortedArray<pollfd, InlineStorage<pollfd, 8>, int, PollToFD>  slct_poll;
 	SortedArray<pollfd*, InlineStorage<pollfd*, 8>, int, PollToFD>  slct_ready;
+#ifdef USE_EPOLL
+	// Max number of events returned by single epoll_wait() call
+	static const int SEL_MAX_EVENTS = 256;
+
+	int		slct_epoll;		// epoll descriptor of multi-client server, created on demand
+	SortedArray<SOCKET, InlineStorage<SOCKET, 8> >  slct_epoll_ready;
+#endif
 #else
 	int		slct_width;
 	fd_set	slct_fdset;
@@ -722,12 +853,16 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	fb_assert(FB_NELEM(protocols_to_try) <= FB_NELEM(cnct->p_cnct_versions));
 	cnct->p_cnct_count = FB_NELEM(protocols_to_try);
 
+	const bool offerZstd = compression && rem_port::checkZstdCompression(*config);
+
 	for (size_t i = 0; i < cnct->p_cnct_count; i++) {
 		cnct->p_cnct_versions[i] = protocols_to_try[i];
 		if (compression && cnct->p_cnct_versions[i].p_cnct_version >= PROTOCOL_VERSION13 &&
 			rem_port::checkCompression())
 		{
 			cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress;
+			if (offerZstd)
+				cnct->p_cnct_versions[i].p_cnct_max_type |= pflag_compress_zstd;
 		}
 	}
 
@@ -840,6 +975,7 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 	}
 
 	bool compress = accept->p_acpt_type & pflag_compress;
+	const bool zstd = accept->p_acpt_type & pflag_compress_zstd;
 	accept->p_acpt_type &= ptype_MASK;
 
 	if (accept->p_acpt_type != ptype_out_of_band) {
@@ -852,7 +988,7 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 
 	if (compress)
 	{
-		port->initCompression();
+		port->initCompression(zstd);
 		port->port_flags |= PORT_compressed;
 	}
 
@@ -1793,6 +1929,8 @@ static void disconnect(rem_port* port)
 
 	if (delayClose)
 	{
+		INET_select->remove(port);
+
 		if (port->port_handle != INVALID_SOCKET)
 			ports_to_close->push(port->port_handle);
 
@@ -2331,10 +2469,14 @@ static bool select_wait( rem_port* main_port, Select* selct)
 					// if process is shuting down - don't listen on main port
 					if (!INET_shutting_down || port != main_port)
 					{
-						selct->set(port->port_handle);
+						selct->set(port);
 						found = true;
 					}
+					else
+						selct->remove(port);
 				}
+				else
+					selct->remove(port);
 			}
 			checkPorts = false;
 		} // port_mutex scope
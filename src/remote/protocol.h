@@ -143,6 +143,7 @@ const USHORT ptype_MASK			= 0xFF;	// Mask - up to 255 types of protocol
 // upper byte is used for protocol flags
 const USHORT pflag_compress			= 0x100;	// Turn on compression if possible
 const USHORT pflag_win_sspi_nego	= 0x200;	// Win_SSPI supports Negotiate security package
+const USHORT pflag_compress_zstd	= 0x400;	// Use zstd instead of zlib, comes with pflag_compress
 
 // Generic object id
 
@@ -251,6 +251,54 @@ USHORT REMOTE_compute_batch_size(rem_port* port,
 }
 
 
+USHORT REMOTE_adapt_batch_size(rem_port* port, Rsr* statement)
+{
+/**************************************
+ *
+ *	R E M O T E _ a d a p t _ b a t c h _ s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the number of records to request in the next
+ *	fetch batch for the given cursor.
+ *
+ *	A new batch is requested when the local buffer is half
+ *	empty, so the pipeline keeps up as long as the client
+ *	consumes half a batch slower than the round trip plus the
+ *	transfer of the next batch.  If the client had to wait for
+ *	the pipelined batch, the round trip was longer than that,
+ *	so the batch is doubled.  Growth is bounded by the cache
+ *	memory the rows of this format may occupy.  Once the client
+ *	keeps up for a few batches in a row, a grown batch is halved
+ *	again, down to the computed base size.
+ *
+ **************************************/
+	const rem_fmt* const format = statement->rsr_select_format;
+	const USHORT base = REMOTE_compute_batch_size(port, 0, op_fetch_response, format);
+
+	ULONG result = MAX(statement->rsr_fetch_batch, base);
+
+	if (statement->rsr_fetch_stalled)
+	{
+		ULONG limit = MAX_ADAPTIVE_CACHE_SIZE / MAX(format->fmt_length, 1);
+		limit = MIN(limit, MAX_USHORT);
+
+		result = MAX(MIN(result * 2, limit), base);
+		statement->rsr_fetch_stalled = false;
+		statement->rsr_fetch_steady = 0;
+	}
+	else if (result > base && ++statement->rsr_fetch_steady >= ADAPTIVE_SHRINK_BATCHES)
+	{
+		result = MAX(result / 2, base);
+		statement->rsr_fetch_steady = 0;
+	}
+
+	statement->rsr_fetch_batch = static_cast<USHORT>(result);
+	return statement->rsr_fetch_batch;
+}
+
+
 Rrq* REMOTE_find_request(Rrq* request, USHORT level)
 {
 /**************************************
@@ -557,7 +605,14 @@ void REMOTE_reset_statement( Rsr* statement)
  **************************************/
 	RMessage* message;
 
-	if (!statement || (!(message = statement->rsr_message)))
+	if (!statement)
+		return;
+
+	// Start the adaptive fetch batch from scratch for the next cursor
+
+	statement->resetFetchBatch();
+
+	if (!(message = statement->rsr_message))
 		return;
 
 	// Reset all the pipeline counters
@@ -1453,6 +1508,59 @@ void rem_port::versionInfo(string& version) const
 
 #ifdef WIRE_COMPRESS_SUPPORT
 static InitInstance<ZLib> zlib;
+static InitInstance<ZStd> zstd;
+
+static bool inflateData(rem_port* port, z_stream& strm)
+{
+	// Decompress data from strm.next_in to strm.next_out
+	// using the algorithm negotiated for the port
+
+	if (!port->port_zstd_recv)
+		return zlib().inflate(&strm, Z_NO_FLUSH) == Z_OK;
+
+	ZStd::InBuffer in = {strm.next_in, strm.avail_in, 0};
+	ZStd::OutBuffer out = {strm.next_out, strm.avail_out, 0};
+
+	const size_t ret = zstd().decompressStream(port->port_zstd_recv, &out, &in);
+	if (zstd().isError(ret))
+		return false;
+
+	strm.next_in += in.pos;
+	strm.avail_in -= (uInt) in.pos;
+	strm.next_out += out.pos;
+	strm.avail_out -= (uInt) out.pos;
+
+	// When output buffer is full decompressor may still have some data
+	port->port_zstd_pending = (out.pos == out.size);
+	return true;
+}
+
+static int deflateData(rem_port* port, z_stream& strm, bool flush)
+{
+	// Compress data from strm.next_in to strm.next_out
+	// using the algorithm negotiated for the port
+
+	if (!port->port_zstd_send)
+	{
+		const int ret = zlib().deflate(&strm, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
+		return (ret == Z_BUF_ERROR) ? Z_OK : ret;
+	}
+
+	ZStd::InBuffer in = {strm.next_in, strm.avail_in, 0};
+	ZStd::OutBuffer out = {strm.next_out, strm.avail_out, 0};
+
+	const size_t ret = zstd().compressStream2(port->port_zstd_send, &out, &in,
+		flush ? ZStd::E_FLUSH : ZStd::E_CONTINUE);
+	if (zstd().isError(ret))
+		return Z_STREAM_ERROR;
+
+	strm.next_in += in.pos;
+	strm.avail_in -= (uInt) in.pos;
+	strm.next_out += out.pos;
+	strm.avail_out -= (uInt) out.pos;
+
+	return Z_OK;
+}
 #endif // WIRE_COMPRESS_SUPPORT
 
 rem_port::~rem_port()
@@ -1481,7 +1589,12 @@ rem_port::~rem_port()
 #endif
 
 #ifdef WIRE_COMPRESS_SUPPORT
-	if (port_compressed)
+	if (port_zstd_send)
+	{
+		zstd().freeCCtx(port_zstd_send);
+		zstd().freeDCtx(port_zstd_recv);
+	}
+	else if (port_compressed)
 	{
 		zlib().deflateEnd(&port_send_stream);
 		zlib().inflateEnd(&port_recv_stream);
@@ -1507,7 +1620,7 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 
 	for (;;)
 	{
-		if (strm.avail_in)
+		if (strm.avail_in || port->port_zstd_pending)
 		{
 #ifdef COMPRESS_DEBUG
 			fprintf(stderr, "Data to inflate %d port %p\n", strm.avail_in, port);
@@ -1517,7 +1630,7 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 #endif
 #endif
 
-			if (zlib().inflate(&strm, Z_NO_FLUSH) != Z_OK)
+			if (!inflateData(port, strm))
 			{
 #ifdef COMPRESS_DEBUG
 				fprintf(stderr, "Inflate error\n");
@@ -1562,7 +1675,7 @@ bool REMOTE_inflate(rem_port* port, PacketReceive* packet_receive, UCHAR* buffer
 	}
 
 	*length = (SSHORT) (buffer_length - strm.avail_out);
-	if (strm.avail_in)	// Z-buffer still has some data - probably can call inflate() once more on them
+	if (strm.avail_in || port->port_zstd_pending)	// Z-buffer still has some data - probably can call inflate() once more on them
 		port->port_z_data = true;
 	else
 		port->port_z_data = false;
@@ -1611,10 +1724,8 @@ bool REMOTE_deflate(RemoteXdr* xdrs, ProtoWrite* proto_write, PacketSend* packet
 		fprintf(stderr, "\n");
 #endif
 #endif
-		int ret = zlib().deflate(&strm, flush ? Z_SYNC_FLUSH : Z_NO_FLUSH);
-		if (ret == Z_BUF_ERROR)
-			ret = 0;
-		if (ret != 0)
+		const int ret = deflateData(port, strm, flush);
+		if (ret != Z_OK)
 		{
 #ifdef COMPRESS_DEBUG
 			fprintf(stderr, "Deflate error %d\n", ret);
@@ -1666,29 +1777,66 @@ bool rem_port::checkCompression()
 #endif
 }
 
-void rem_port::initCompression()
+bool rem_port::checkZstdCompression(const Config* config)
+{
+#ifdef WIRE_COMPRESS_SUPPORT
+	const char* const type = config->getWireCompressionType();
+	return type && fb_utils::stricmp(type, "zstd") == 0 && zstd();
+#else
+	return false;
+#endif
+}
+
+void rem_port::initCompression(bool useZstd)
 {
 #ifdef WIRE_COMPRESS_SUPPORT
-	if (port_protocol >= PROTOCOL_VERSION13 && !port_compressed && zlib())
+	if (port_protocol >= PROTOCOL_VERSION13 && !port_compressed && (useZstd ? zstd() : zlib()))
 	{
-		port_send_stream.zalloc = ZLib::allocFunc;
-		port_send_stream.zfree = ZLib::freeFunc;
-		port_send_stream.opaque = Z_NULL;
-		int ret = zlib().deflateInit(&port_send_stream, Z_DEFAULT_COMPRESSION);
-		if (ret != Z_OK)
-			(Arg::Gds(isc_deflate_init) << Arg::Num(ret)).raise();
-		port_send_stream.next_out = NULL;
-
-		port_recv_stream.zalloc = ZLib::allocFunc;
-		port_recv_stream.zfree = ZLib::freeFunc;
-		port_recv_stream.opaque = Z_NULL;
-		port_recv_stream.avail_in = 0;
-		port_recv_stream.next_in = Z_NULL;
-		ret = zlib().inflateInit(&port_recv_stream);
-		if (ret != Z_OK)
+		const int level = getPortConfig()->getWireCompressionLevel();
+
+		if (useZstd)
+		{
+			port_zstd_send = zstd().createCCtx();
+			port_zstd_recv = zstd().createDCtx();
+			if (!port_zstd_send || !port_zstd_recv)
+			{
+				if (port_zstd_send)
+					zstd().freeCCtx(port_zstd_send);
+				if (port_zstd_recv)
+					zstd().freeDCtx(port_zstd_recv);
+				port_zstd_send = NULL;
+				port_zstd_recv = NULL;
+				BadAlloc::raise();
+			}
+
+			zstd().setParameter(port_zstd_send, ZStd::C_COMPRESSION_LEVEL, level ? level : 1);
+
+			port_send_stream.next_out = NULL;
+			port_recv_stream.avail_in = 0;
+			port_zstd_pending = false;
+		}
+		else
 		{
-			zlib().deflateEnd(&port_send_stream);
-			(Arg::Gds(isc_inflate_init) << Arg::Num(ret)).raise();
+			port_send_stream.zalloc = ZLib::allocFunc;
+			port_send_stream.zfree = ZLib::freeFunc;
+			port_send_stream.opaque = Z_NULL;
+			int ret = zlib().deflateInit(&port_send_stream,
+				(level > 0) ? MIN(level, Z_BEST_COMPRESSION) : Z_DEFAULT_COMPRESSION);
+			if (ret != Z_OK)
+				(Arg::Gds(isc_deflate_init) << Arg::Num(ret)).raise();
+			port_send_stream.next_out = NULL;
+
+			port_recv_stream.zalloc = ZLib::allocFunc;
+			port_recv_stream.zfree = ZLib::freeFunc;
+			port_recv_stream.opaque = Z_NULL;
+			port_recv_stream.avail_in = 0;
+			port_recv_stream.next_in = Z_NULL;
+			ret = zlib().inflateInit(&port_recv_stream);
+			if (ret != Z_OK)
+			{
+				zlib().deflateEnd(&port_send_stream);
+				(Arg::Gds(isc_inflate_init) << Arg::Num(ret)).raise();
+			}
 		}
 
 		try
@@ -1697,8 +1845,18 @@ void rem_port::initCompression()
 		}
 		catch (const Exception&)
 		{
-			zlib().deflateEnd(&port_send_stream);
-			zlib().inflateEnd(&port_recv_stream);
+			if (useZstd)
+			{
+				zstd().freeCCtx(port_zstd_send);
+				zstd().freeDCtx(port_zstd_recv);
+				port_zstd_send = NULL;
+				port_zstd_recv = NULL;
+			}
+			else
+			{
+				zlib().deflateEnd(&port_send_stream);
+				zlib().inflateEnd(&port_recv_stream);
+			}
 			throw;
 		}
 
@@ -102,6 +102,8 @@ const ULONG MIN_ROWS_PER_BATCH = 10;
 const ULONG MAX_ROWS_PER_BATCH = 1000;
 
 const ULONG MAX_BATCH_CACHE_SIZE = 1024 * 1024; // 1 MB
+const ULONG MAX_ADAPTIVE_CACHE_SIZE = 8 * 1024 * 1024; // 8 MB, limit for grown batches
+const USHORT ADAPTIVE_SHRINK_BATCHES = 4;	// batches without a stall before a grown batch is halved
 
 // fwd. decl.
 namespace Firebird {
@@ -506,6 +508,9 @@ struct Rsr : public Firebird::GlobalStorage, public TypedHandle<rem_type_rsr>
 	USHORT			rsr_msgs_waiting; 	// count of full rsr_messages
 	USHORT			rsr_reorder_level; 	// Trigger pipelining at this level
 	USHORT			rsr_batch_count; 	// Count of batches in pipeline
+	USHORT			rsr_fetch_batch;	// Adaptive prefetch batch size, 0 if not known yet
+	bool			rsr_fetch_stalled;	// Client waited for the pipelined batch
+	USHORT			rsr_fetch_steady;	// Batches received in time since the last resize
 
 	Firebird::string rsr_cursor_name;	// Name for cursor to be set on open
 	bool			rsr_delayed_format;	// Out format was delayed on execute, set it on fetch
@@ -574,6 +579,7 @@ public:
 		rsr_format(0), rsr_message(0), rsr_buffer(0), rsr_status(0),
 		rsr_id(0), rsr_fmt_length(0),
 		rsr_rows_pending(0), rsr_msgs_waiting(0), rsr_reorder_level(0), rsr_batch_count(0),
+		rsr_fetch_batch(0), rsr_fetch_stalled(false), rsr_fetch_steady(0),
 		rsr_cursor_name(getPool()), rsr_delayed_format(false), rsr_timeout(0), rsr_self(NULL),
 		rsr_fetch_operation(fetch_next), rsr_fetch_position(0)
 	{ }
@@ -607,6 +613,13 @@ public:
 	void checkCursor();
 	void checkBatch();
 
+	void resetFetchBatch()
+	{
+		rsr_fetch_batch = 0;
+		rsr_fetch_stalled = false;
+		rsr_fetch_steady = 0;
+	}
+
 	SLONG getCursorAdjustment() const
 	{
 		if (rsr_fetch_operation != fetch_next && rsr_fetch_operation != fetch_prior)
@@ -1147,6 +1160,7 @@ struct rem_port : public Firebird::GlobalStorage, public Firebird::RefCounted
 	SLONG			port_dummy_timeout;	// time remaining until keepalive packet
 	SOCKET			port_handle;		// handle for INET socket
 	SOCKET			port_channel;		// handle for connection (from by OS)
+	SOCKET			port_select_handle;	// handle registered in INET select loop
 	struct linger	port_linger;		// linger value as defined by SO_LINGER
 	Rdb*			port_context;
 	Thread::Handle	port_events_thread;	// handle of thread, handling incoming events
@@ -1296,8 +1310,11 @@ public:
 
 
 #ifdef WIRE_COMPRESS_SUPPORT
-	z_stream port_send_stream, port_recv_stream;
+	z_stream port_send_stream, port_recv_stream;	// with zstd only buffer pointers are used
 	UCharArrayAutoPtr	port_compressed;
+	Firebird::ZStd::CCtx*	port_zstd_send;		// zstd streams, if negotiated
+	Firebird::ZStd::DCtx*	port_zstd_recv;
+	bool				port_zstd_pending;		// zstd decompressor may have buffered output
 #endif
 
 public:
@@ -1313,7 +1330,8 @@ public:
 		port_server(0), port_server_flags(0), port_protocol(0), port_buff_size(rpt / 2),
 		port_flags(0), port_partial_data(false), port_z_data(false),
 		port_connect_timeout(0), port_dummy_packet_interval(0),
-		port_dummy_timeout(0), port_handle(INVALID_SOCKET), port_channel(INVALID_SOCKET), port_context(0),
+		port_dummy_timeout(0), port_handle(INVALID_SOCKET), port_channel(INVALID_SOCKET),
+		port_select_handle(INVALID_SOCKET), port_context(0),
 		port_events_thread(0), port_thread_guard(0),
 #ifdef WIN_NT
 		port_pipe(INVALID_HANDLE_VALUE), port_event(INVALID_HANDLE_VALUE),
@@ -1340,6 +1358,11 @@ public:
 		addRef();
 		memset(&port_linger, 0, sizeof port_linger);
 		memset(port_buffer, 0, rpt);
+#ifdef WIRE_COMPRESS_SUPPORT
+		port_zstd_send = NULL;
+		port_zstd_recv = NULL;
+		port_zstd_pending = false;
+#endif
 #ifdef DEV_BUILD
 		++portCounter;
 #endif
@@ -1357,8 +1380,9 @@ private:
 	friend class Firebird::RefPtr<rem_port>;
 
 public:
-	void initCompression();
+	void initCompression(bool useZstd);
 	static bool checkCompression();
+	static bool checkZstdCompression(const Firebird::Config* config);
 	void linkParent(rem_port* const parent);
 	void unlinkParent();
 	Firebird::RefPtr<const Firebird::Config> getPortConfig();
@@ -841,6 +841,12 @@ namespace
 					const auto blockLength = header.length;
 					const auto length = sizeof(Block) + blockLength;
 
+					// Position is saved (and synced) only after blocks that complete
+					// a transaction or do not belong to any. If the replication is
+					// interrupted in between, replica transactions are rolled back and
+					// their blocks are replayed starting from the last saved position.
+					const bool savePosition = !header.traNumber || (header.flags & BLOCK_END_TRANS);
+
 					if (blockLength)
 					{
 						const bool rewind = (sequence < last_sequence ||
@@ -858,7 +864,8 @@ namespace
 
 					totalLength += length;
 
-					control.savePartial(sequence, totalLength, transactions);
+					if (savePosition)
+						control.savePartial(sequence, totalLength, transactions);
 				}
 
 				control.saveComplete(sequence, transactions);
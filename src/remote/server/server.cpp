@@ -742,7 +742,7 @@ public:
 				}
 
 				if (send->p_acpt.p_acpt_type & pflag_compress)
-					authPort->initCompression();
+					authPort->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 				authPort->send(send);
 				if (send->p_acpt.p_acpt_type & pflag_compress)
 					authPort->port_flags |= PORT_compressed;
@@ -1956,6 +1956,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	USHORT version = 0;
 	USHORT type = 0;
 	bool compress = false;
+	bool zstd = false;
 	bool accepted = false;
 	USHORT weight = 0;
 	const p_cnct::p_cnct_repeat* protocol = connect->p_cnct_versions;
@@ -1976,6 +1977,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 			architecture = protocol->p_cnct_architecture;
 			type = MIN(protocol->p_cnct_max_type & ptype_MASK, ptype_lazy_send);
 			compress = protocol->p_cnct_max_type & pflag_compress;
+			zstd = compress && (protocol->p_cnct_max_type & pflag_compress_zstd);
 		}
 	}
 
@@ -1984,7 +1986,12 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpd.p_acpt_version = port->port_protocol = version;
 	send->p_acpd.p_acpt_architecture = architecture;
-	send->p_acpd.p_acpt_type = type | (compress ? pflag_compress : 0);
+	if (zstd && !rem_port::checkZstdCompression(port->getPortConfig()))
+		zstd = false;
+
+	const USHORT compressFlags = compress ? (pflag_compress | (zstd ? pflag_compress_zstd : 0)) : 0;
+
+	send->p_acpd.p_acpt_type = type | compressFlags;
 #ifdef TRUSTED_AUTH
 	send->p_acpd.p_acpt_type |= pflag_win_sspi_nego;
 #endif
@@ -1992,7 +1999,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_acpt.p_acpt_version = port->port_protocol = version;
 	send->p_acpt.p_acpt_architecture = architecture;
-	send->p_acpt.p_acpt_type = type | (compress ? pflag_compress : 0);
+	send->p_acpt.p_acpt_type = type | compressFlags;
 
 	// modify the version string to reflect the chosen protocol
 	string buffer;
@@ -2186,7 +2193,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 
 	send->p_operation = returnData ? op_accept_data : op_accept;
 	if (send->p_acpt.p_acpt_type & pflag_compress)
-		port->initCompression();
+		port->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 	port->send(send);
 	if (send->p_acpt.p_acpt_type & pflag_compress)
 		port->port_flags |= PORT_compressed;
@@ -2215,7 +2222,7 @@ void ConnectAuth::accept(PACKET* send, Auth::WriterImplementation*)
 		authPort->extractNewKeys(s);
 		send->p_acpd.p_acpt_authenticated = 1;
 		if (send->p_acpt.p_acpt_type & pflag_compress)
-			authPort->initCompression();
+			authPort->initCompression(send->p_acpt.p_acpt_type & pflag_compress_zstd);
 		authPort->send(send);
 		if (send->p_acpt.p_acpt_type & pflag_compress)
 			authPort->port_flags |= PORT_compressed;